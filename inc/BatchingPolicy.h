@@ -0,0 +1,40 @@
+#ifndef _BATCHING_POLICY_H
+#define _BATCHING_POLICY_H
+
+// batching policies: which requests revealed one after another are answered by the same re-optimization
+#define DARPH_BATCH_WINDOW  0 // all requests revealed within a fixed window after the first one
+#define DARPH_BATCH_SIZE    1 // up to max_size requests, closed when full or after max_delay
+#define DARPH_BATCH_SLO     2 // window adapted to a latency target (additive increase, multiplicative decrease)
+
+// Accumulate requests revealed within a window into one batch of new requests
+class BatchingPolicy {
+private:
+    // statistics of one batch
+    struct Batch {
+        double close; // time at which the batch is revealed to the solver [min]
+        int size;
+        double sum_delay; // sum of the times the requests waited for the batch to close [min]
+        double max_delay; // longest time a request waited for the batch to close [min]
+        double latency; // longest time from a reveal until the answer, i.e. delay plus solve time [s]
+    };
+    std::vector<Batch> history;
+
+    int policy;
+    double window; // current window [min]
+    int max_size; // at most max_size requests per batch, unbounded if 0
+    double max_delay; // no request waits longer than max_delay for its batch to close [min]
+    double slo; // latency target [s]
+    double increase; // additive increase of the window if the latency target is met [min]
+
+public:
+    BatchingPolicy(int policy, double window, int max_size, double max_delay, double slo);
+
+    double close(const std::vector<std::pair<double,int>>& pending, std::vector<int>& batch) const;
+    void record(double close, const std::vector<double>& reveals, double solve_time);
+
+    double get_window() const {return window;}
+    double get_length() const {return (policy == DARPH_BATCH_SIZE) ? max_delay : window;} // longest time a batch stays open
+    void print_summary() const;
+};
+
+#endif
@@ -12,8 +12,10 @@ private:
     double max_route_duration; // = max duration of SERVICE  
     double planning_horizon;
     int veh_capacity;
-    double **d; // The distance matrix d
-    double **tt; // The travel times matrix tt 
+    DistanceProvider d; // The distance matrix d
+    DistanceProvider tt; // The travel times matrix tt, shares d in instance mode 1
+    int distance_type = DARPH_DISTANCE_AUTO; // backend of d and tt if computed from coordinates
+    int compact_format = DARPH_COMPACT_DISTANCES; // compact storage of dense d and tt
 
     class DARPNode *nodes; // Array of nodes - contains coordinates, time windows, load
 
@@ -32,6 +34,17 @@ private:
     int num_known_requests;
     std::vector<int> known_requests; 
     
+    // distance matrix of instance mode 2
+    void read_costs(const std::string& path);
+    // compiled instance, d and tt are stored in its mapping
+    MappedFile* mapped = nullptr;
+    std::string source_file; // text files read, stored in a compiled instance
+    std::string costs_file;
+    bool read_binary(std::string infile);
+    void compact_distances();
+    void check_demand() const;
+    // time windows of request i as preprocess() tightens them, false if they become empty
+    bool tighten_time_windows(int i, DARPNode& pickup, DARPNode& dropoff) const;
     
 public:
     
@@ -42,19 +55,37 @@ public:
         
     int get_instance_mode() const {return instance_mode;}
     void set_instance_mode(int i) {instance_mode = i;}
+    void set_distance_type(int type) {distance_type = type;}
+    void set_compact(int format) {compact_format = format;}
+    const DistanceProvider& get_d() const {return d;}
+    const DistanceProvider& get_tt() const {return tt;}
 
     // // file processing
     void read_file(std::string infile, std::string data_directory, std::string instance);
+    void write_binary(std::string outfile) const;
+    // number of entries of d and tt that differ from those of other in any bit
+    size_t compare_distances(const DARP& other) const;
     void transform_dynamic(double share_static_requests = 0.25, double beta = 60);
+    // all requests known from the beginning
+    void make_static();
+    // sub-instance with the given requests of D, renumbered from 1, and the given number of its vehicles
+    void extract(const DARP& D, const std::vector<int>& requests, int vehicles);
     // tighten time windows if necessary
     void preprocess();
+    // room for requests that are not in the instance, e.g. new requests of a request stream
+    void reserve_requests(int slots);
+    // a new request in the reserved slot i, false if it is infeasible (load, time windows)
+    bool fill_request(int i, const DARPNode& pickup, const DARPNode& dropoff);
     
 
     template<int Q>
     friend class DARPGraph;
     template<int Q>
     friend class RollingHorizon;
+    template<int Q>
+    friend class DelayIntegration;
     friend class DARPSolver;
+    friend class TabuSearch;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef _DARP_BINARY_H
+#define _DARP_BINARY_H
+
+// Compiled instance (.darp) written by darp_compile: header, node records and the matrices d and tt,
+// each matrix (2n+1) x (2n+1) doubles row by row at a 64-byte aligned offset, in the byte order of the machine
+// that compiled it; DARP maps the file and uses the matrices in place. Size and modification time of the
+// text files it was compiled from are stored, a compiled instance older than its text files is not used
+struct DARPBinaryHeader {
+    static constexpr uint32_t magic_number = 0x50524144; // "DARP"
+    static constexpr uint32_t current_version = 2;
+
+    uint32_t magic;
+    uint32_t version;
+    int32_t instance_mode;
+    int32_t num_vehicles;
+    int32_t num_nodes; // without depot
+    int32_t veh_capacity;
+    double max_route_duration;
+    double planning_horizon;
+    uint64_t nodes_offset;
+    uint64_t d_offset;
+    uint64_t tt_offset; // = d_offset if tt equals d (instance mode 1), stored once
+    uint64_t source_size; // instance file
+    int64_t source_mtime;
+    uint64_t costs_size; // distance matrix of instance mode 2, 0 if there is none
+    int64_t costs_mtime;
+};
+
+// static data of a node, attributes of the search are not stored
+struct DARPBinaryNode {
+    int32_t id;
+    int32_t demand;
+    double x;
+    double y;
+    double tw_length;
+    double max_ride_time;
+    double service_time;
+    double start_tw;
+    double end_tw;
+};
+
+// path of the compiled instance if there is an up-to-date one, otherwise of the text instance
+std::string DARPInstancePath(const std::string& data_directory, const std::string& instance);
+// distance matrix of an instance of mode 2
+std::string DARPCostsPath(const std::string& data_directory, const std::string& instance);
+
+
+#endif
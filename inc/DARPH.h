@@ -30,20 +30,36 @@
 #include <fstream> // to read file while ignoring whitespaces
 #include <string> 
 #include <cstring> // strcpy()
+#include <charconv> // from_chars, parse instance files
 
 #include <map>
+#include <memory> // shared tile cache of the distance matrices
+#include <thread> // overlap model update and solve
+#include <mutex>
+#include <atomic> // hand out time slices to worker threads
+#include <queue> // simulation clock
 
 
 #include "TerminalOutput.h"
 #include "DARPUtils.h"
 #include "DARPNode.h"
+#include "DistanceProvider.h"
 #include "DARPRoute.h"
 #include "DARPDebug.h"
 #include "DARP.h"
+#include "DARPBinary.h"
 #include "HashFunction.h"
 #include "DARPGraph.h"
 #include "DARPSolver.h"
+#include "DelayModel.h"
+#include "DelayTrace.h"
 #include "DelayIntegration.h"
+#include "IncumbentCallback.h"
+#include "SolveBudget.h"
+#include "BatchingPolicy.h"
+#include "EventQueue.h"
+#include "RequestStream.h"
+#include "TabuSearch.h"
 #include "RollingHorizon.h"
 
 
@@ -59,13 +59,15 @@ public:
 
     // check pairwise feasibility of paths
     void check_paths(DARP& D);
-    void check_new_paths(DARP& D, double w1 = 1, double w2 = 60, double w3 = 0.1);
+    void check_new_path(DARP& D, int i, int j, double w1, double w3);
+    void precheck_new_paths(DARP& D, const std::vector<int>& known, const std::vector<int>& requests, double w1 = 1, double w3 = 0.1);
+    void check_new_paths(DARP& D, double w1 = 1, double w2 = 60, double w3 = 0.1, bool prechecked = false);
 
     // 8-step route evaluation scheme by Cordeau and Laporte (2003)
     bool update_vertices(DARP& D, DARPRoute&); // modified != tabu search
     bool update_vertices(DARP& D, DARPRoute&, int); // modified != tabu search
     bool eight_step(DARP& D, DARPRoute&); // modified != tabu search
-    bool eight_step(DARP& D, DARPRoute&, int); // modified != tabu search
+    bool eight_step(DARP& D, DARPRoute&, int, double earliest_departure = 0); // modified != tabu search
     
     // feasible path heuristic
     void find_min(double***, int, std::vector<std::array<int,3>>&) const;
@@ -1,7 +1,47 @@
 #ifndef _DARP_UTIL_H
 #define _DARP_UTIL_H
 
-int DARPGetDimension(std::string); 
+int DARPGetDimension(std::string);
+
+// memory map of a whole file, the text is parsed in place; a copy-on-write map
+// can be written to without changing the file
+class MappedFile {
+private:
+    char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+
+public:
+    explicit MappedFile(const std::string& filename, bool copy_on_write = false);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const {return opened;}
+    const char* begin() const {return data;}
+    const char* end() const {return data + size;}
+    char* writable_begin() const {return data;} // only for copy-on-write maps
+};
+
+// skip blanks and read the next number at p with std::from_chars, p is moved behind it
+template<typename T>
+bool parse_next(const char*& p, const char* end, T& value)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    const auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+        return false;
+    p = result.ptr;
+    return true;
+}
+
+// move p to the beginning of the next line
+inline void skip_line(const char*& p, const char* end)
+{
+    const void* newline = memchr(p, '\n', end - p);
+    p = newline ? static_cast<const char*>(newline) + 1 : end;
+}
 
 
 #endif
@@ -7,32 +7,33 @@ private:
     typedef std::array<int,S> NODE;
     typedef std::array<NODE,2> ARC;
 
-    double delay;
-    double probability;
+    const DelayModel* model;
+    // the delays of an iteration are keyed on (seed, iteration, arc)
+    uint32_t seed_value = 1;
+    uint32_t iteration = 0;
 
-    std::random_device rd;
-    std::mt19937 gen{rd()};
-    std::uniform_real_distribution<> dis{0, 1};
+    DelayTrace* trace = nullptr; // records the injected delays
+    const ReplayDelay* replay = nullptr; // model if recorded delays are replayed
 
     TerminalOutputFormatter<S>* tof;
 
 public:
-    DelayIntegration(double probability, double delay, TerminalOutputFormatter<S>* tof);
+    DelayIntegration(const DelayModel* model, TerminalOutputFormatter<S>* tof);
+    void seed(unsigned int s) {seed_value = s;}
+    void set_model(const DelayModel* m) {model = m;}
+    void set_trace(DelayTrace* t) {trace = t;}
+    void set_replay(const ReplayDelay* r) {replay = r;}
 
     void incorporate_delay(std::stringstream& name, 
+                        const DARP& D, 
                         IloEnv& env, 
                         IloModel& model, 
                         IloNumVarArray& B, 
                         IloRangeArray& fixed_B, 
-                        std::vector<ARC> fixed_edges,
+                        const std::vector<ARC>& fixed_edges,
                         std::pair<NODE,double>* active_node,
-                        std::unordered_map<NODE, uint64_t, HashFunction<S>> vmap,
+                        const std::unordered_map<NODE, uint64_t, HashFunction<S>>& vmap,
                         const double epsilon,
                         int n);
-
-    void propagate_delay(NODE delayed_event, 
-                        std::map<NODE, double> &node_delay, 
-                        std::vector<ARC> fixed_edges, 
-                        int n);
 };
 
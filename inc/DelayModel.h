@@ -0,0 +1,79 @@
+#ifndef _DELAY_MODEL_H
+#define _DELAY_MODEL_H
+
+// delay models: distribution of the delay of a leg of a route
+#define DARPH_DELAY_FIXED       0 // fixed delay with a given probability
+#define DARPH_DELAY_LOGNORMAL   1 // travel time multiplied by a lognormal factor
+#define DARPH_DELAY_TIME_OF_DAY 2 // fixed delay with probability and size depending on the time of day (profile file)
+#define DARPH_DELAY_EMPIRICAL   3 // delays drawn from a histogram (histogram file)
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al., 2011): the numbers of a leg depend only on
+// (seed, iteration, leg, scenario), i.e. delays are reproducible regardless of the number of threads and the order of evaluation
+class Philox {
+private:
+    static const uint32_t M0 = 0xD2511F53;
+    static const uint32_t M1 = 0xCD9E8D57;
+    static const uint32_t W0 = 0x9E3779B9;
+    static const uint32_t W1 = 0xBB67AE85;
+
+public:
+    static std::array<uint32_t,4> generate(std::array<uint32_t,4> counter, std::array<uint32_t,2> key);
+    // four uniform random numbers in (0,1) for the leg from event from to event to
+    static std::array<double,4> uniform(uint32_t seed, uint32_t iteration, uint32_t from, uint32_t to, uint32_t scenario = 0);
+};
+
+// Delay of a leg of a route
+class DelayModel {
+public:
+    virtual ~DelayModel() {}
+    // delay [min] of a leg with travel time travel_time [min] started at time [min], u are uniform random numbers in (0,1)
+    virtual double sample(const std::array<double,4>& u, double travel_time, double time) const = 0;
+    // delay of the leg from event from to event to in the given iteration and scenario
+    virtual double sample(uint32_t seed, uint32_t iteration, int from, int to, uint32_t scenario, double travel_time, double time) const
+    {
+        return sample(Philox::uniform(seed, iteration, from, to, scenario), travel_time, time);
+    }
+
+    static DelayModel* create(int type, double probability, double delay, double mu, double sigma, const std::string& file);
+};
+
+class FixedDelay : public DelayModel {
+private:
+    double probability;
+    double delay; // [min]
+
+public:
+    FixedDelay(double probability, double delay) : probability(probability), delay(delay) {}
+    double sample(const std::array<double,4>& u, double travel_time, double time) const override;
+};
+
+class LognormalDelay : public DelayModel {
+private:
+    double mu;
+    double sigma;
+
+public:
+    LognormalDelay(double mu, double sigma) : mu(mu), sigma(sigma) {}
+    double sample(const std::array<double,4>& u, double travel_time, double time) const override;
+};
+
+class TimeOfDayDelay : public DelayModel {
+private:
+    std::vector<std::array<double,3>> profile; // start [min], probability, delay [min], sorted by start
+
+public:
+    TimeOfDayDelay(const std::string& file);
+    double sample(const std::array<double,4>& u, double travel_time, double time) const override;
+};
+
+class EmpiricalDelay : public DelayModel {
+private:
+    std::vector<double> delays; // [min]
+    std::vector<double> cdf;
+
+public:
+    EmpiricalDelay(const std::string& file);
+    double sample(const std::array<double,4>& u, double travel_time, double time) const override;
+};
+
+#endif
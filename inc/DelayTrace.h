@@ -0,0 +1,55 @@
+#ifndef _DELAY_TRACE_H
+#define _DELAY_TRACE_H
+
+// Binary trace of a run: reveals of requests and delays injected at fixed edges
+// file: magic "DTRC" and version (4 bytes each), then records of type (1 byte), iteration, from, to (4 bytes each) and value (8 bytes)
+class DelayTrace {
+private:
+    std::ofstream out;
+
+public:
+    static constexpr uint32_t magic = 0x43525444;
+    static constexpr uint32_t version = 1;
+    enum Record : uint8_t {reveal = 0, delay = 1};
+
+    void open(const std::string& file);
+    bool is_open() const {return out.is_open();}
+    void write(Record type, uint32_t iteration, int from, int to, double value);
+    void record_reveal(int i, double time) {write(reveal, 0, i, 0, time);}
+    void record_delay(uint32_t iteration, int from, int to, double delay) {write(Record::delay, iteration, from, to, delay);}
+};
+
+// a delay of the text log is matched to the leg started closest to its time, at most this many minutes apart
+#define DARPH_REPLAY_WINDOW 15
+
+// Replay of a trace or of a text log of real delays with lines "r request time" and "d from to time delay"
+// (time [min] at which the leg from event from to event to was started); the delays of a trace are keyed
+// by the iteration in which the edge was fixed, those of a log by leg and matched by time.
+// Legs without a matching delay are not delayed
+class ReplayDelay : public DelayModel {
+private:
+    struct Entry {
+        double time; // start of the leg, only for the text log
+        double delay;
+    };
+    std::vector<Entry> entries;
+    mutable std::vector<bool> used; // realized at a fixed edge
+    std::unordered_map<uint64_t,int> delays; // trace: entry of (iteration, leg)
+    std::unordered_map<uint64_t,std::vector<int>> legs; // log: entries of a leg sorted by time
+    std::unordered_map<int,double> reveals;
+    static uint64_t key(uint32_t iteration, int from, int to) {return (uint64_t(iteration) << 42) ^ (uint64_t(from) << 21) ^ uint64_t(to);}
+    void read_text(const std::string& file);
+    int find(uint32_t iteration, int from, int to, double time) const;
+
+public:
+    ReplayDelay(const std::string& file);
+    double sample(const std::array<double,4>& u, double travel_time, double time) const override {return 0;}
+    double sample(uint32_t seed, uint32_t iteration, int from, int to, uint32_t scenario, double travel_time, double time) const override;
+    double realize(uint32_t iteration, int from, int to, double time) const;
+    bool reveal_time(int i, double& time) const;
+    int get_num_delays() const {return entries.size();}
+    int get_num_unused() const {return std::count(used.begin(), used.end(), false);}
+    int get_num_reveals() const {return reveals.size();}
+};
+
+#endif
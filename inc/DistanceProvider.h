@@ -0,0 +1,116 @@
+#ifndef _DISTANCE_PROVIDER_H
+#define _DISTANCE_PROVIDER_H
+
+// storage of the distance and travel time matrices
+#define DARPH_DISTANCE_AUTO      -1 // dense up to DARPH_DENSE_LIMIT bytes, otherwise tiled
+#define DARPH_DISTANCE_DENSE      0
+#define DARPH_DISTANCE_COMPUTED   1
+#define DARPH_DISTANCE_TILED      2
+
+// compact storage of a dense matrix, only used if every value is reproduced exactly
+#define DARPH_COMPACT_NONE        0
+#define DARPH_COMPACT_FLOAT       1 // float32
+#define DARPH_COMPACT_FIXED16     2 // 16-bit centi-minutes, values up to 655.35
+// default of --compact, e.g. -DDARPH_COMPACT_DISTANCES=DARPH_COMPACT_FIXED16
+#ifndef DARPH_COMPACT_DISTANCES
+#define DARPH_COMPACT_DISTANCES   DARPH_COMPACT_NONE
+#endif
+
+#define DARPH_DENSE_LIMIT         (size_t(1) << 30)
+#define DARPH_TILE_SIZE           64
+#define DARPH_TILE_SLOTS          64 // tiles cached by each thread
+
+// (2n+1) x (2n+1) matrix read as M[i][j]: either dense (owned or in the mapping of a compiled instance)
+// or computed from the coordinates of the nodes as the rounded Euclidean distance of instance mode 1,
+// optionally with a cache of recently used tiles in each thread; providers can share the storage of another one
+class DistanceProvider {
+private:
+    int type = DARPH_DISTANCE_DENSE;
+    int dimension = 0;
+    double* storage = nullptr;
+    bool owner = false;
+
+    // compact storage instead of storage, shared with aliases
+    std::shared_ptr<std::vector<float>> singles;
+    std::shared_ptr<std::vector<uint16_t>> centis;
+    const float* single_data = nullptr;
+    const uint16_t* centi_data = nullptr;
+    bool float_rounded = false; // values were rounded in float as roundf(t * 100) / 100
+
+    // coordinates of the nodes for the computed and tiled backends
+    std::vector<double> x;
+    std::vector<double> y;
+
+    // tiles of the tiled backend are cached per thread under this id, which changes with the values
+    uint64_t cache_id = 0;
+
+    void release();
+    double compute(int i, int j) const;
+    double cached(int i, int j) const;
+
+public:
+    class Row {
+    private:
+        const DistanceProvider& provider;
+        const int i;
+    public:
+        Row(const DistanceProvider& provider, int i) : provider{provider}, i{i} {}
+        double operator[](int j) const {return provider.get(i, j);}
+    };
+
+    // copy of the last row filled, for loops over the columns of a row
+    class RowBuffer {
+    private:
+        const DistanceProvider& provider;
+        int i = -1;
+        std::vector<double> values;
+    public:
+        explicit RowBuffer(const DistanceProvider& provider) : provider{provider}, values(provider.dimension) {}
+        const double* operator()(int i)
+        {
+            if (i != this->i)
+            {
+                provider.fill_row(i, 0, provider.dimension, values.data());
+                this->i = i;
+            }
+            return values.data();
+        }
+    };
+
+    DistanceProvider() {}
+    ~DistanceProvider();
+    DistanceProvider(const DistanceProvider&) = delete;
+    DistanceProvider& operator=(const DistanceProvider&) = delete;
+
+    void dense(int dimension);
+    void map(int dimension, double* data);
+    bool compress(int format);
+    void computed(const DARPNode* nodes, int dimension, int type);
+    void alias(const DistanceProvider& other);
+    void place(const DARPNode* nodes, int k);
+
+    double get(int i, int j) const
+    {
+        const size_t k = size_t(i) * dimension + j;
+        if (storage)
+            return storage[k];
+        if (centi_data)
+            return float_rounded ? double(float(centi_data[k]) / 100) : centi_data[k] / 100.0;
+        if (single_data)
+            return single_data[k];
+        return (type == DARPH_DISTANCE_TILED) ? cached(i, j) : compute(i, j);
+    }
+    Row operator[](int i) const {return Row(*this, i);}
+    void set(int i, int j, double value) {storage[size_t(i) * dimension + j] = value;}
+    double* data() {return storage;} // only dense
+    void fill_row(int i, int first, int last, double* out) const;
+
+    int get_type() const {return type;}
+    bool is_dense() const {return storage || centi_data || single_data;}
+    bool shares(const DistanceProvider& other) const {return storage == other.storage && single_data == other.single_data && centi_data == other.centi_data;}
+    bool is_compact() const {return centi_data || single_data;}
+    size_t memory() const;
+};
+
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef _EVENT_QUEUE_H
+#define _EVENT_QUEUE_H
+
+// events of the simulation, further types (e.g. vehicle breakdowns) are added here and handled where the rolling horizon pops them
+enum class EventType {reveal, release, horizon};
+
+struct Event
+{
+    double time; // [min]
+    EventType type;
+    int id; // request of a reveal or release, unused otherwise
+};
+
+// Simulation clock: pending events ordered by time, reveals first among events at the same time
+class EventQueue {
+private:
+    struct Later {
+        bool operator()(const Event& a, const Event& b) const;
+    };
+    std::priority_queue<Event, std::vector<Event>, Later> queue;
+
+public:
+    void push(const Event& e) {queue.push(e);}
+    void push(double time, EventType type, int id = 0) {queue.push({time, type, id});}
+    Event pop();
+    const Event& top() const {return queue.top();}
+    bool empty() const {return queue.empty();}
+    int size() const {return queue.size();}
+
+    double advance(EventType type);
+};
+
+#endif
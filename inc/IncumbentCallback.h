@@ -0,0 +1,65 @@
+#include <ilcplex/ilocplex.h>
+#include <ilconcert/iloexpression.h>
+
+#ifndef _INCUMBENT_CALLBACK_H
+#define _INCUMBENT_CALLBACK_H
+
+// early-stop policies of the incumbent callback
+#define DARPH_STOP_NONE       0 // run until the time limit
+#define DARPH_STOP_GAP        1 // stop as soon as the relative MIP gap is below target_gap
+#define DARPH_STOP_STABILITY  2 // stop if no decision on a new request changed for stability_sec seconds
+#define DARPH_STOP_DECIDED    3 // stop as soon as every new request has an answer (accepted or denied) that never changed
+
+// Record the answers to the new requests contained in every incumbent found by CPLEX
+template<int S>
+class IncumbentCallback : public IloCplex::Callback::Function {
+private:
+    using clock = std::chrono::system_clock;
+    using sec = std::chrono::duration<double>;
+
+    // a new request, its acceptance variable and, for each of its pick-up nodes, the time variable and the incoming arc variables
+    struct WatchedRequest {
+        int request;
+        IloNumVar p;
+        std::vector<std::pair<IloNumVar, std::vector<IloNumVar>>> pickups;
+        bool accepted;
+        double pickup;
+        double answered; // seconds after start of solve at which the current answer was found first
+        bool revised; // the answer changed after it was first published
+    };
+    std::vector<WatchedRequest> watched;
+    std::mutex mtx;
+
+    clock::time_point start;
+    double incumbent_obj;
+    double last_change;
+    double first_incumbent;
+    double last_incumbent;
+    int num_incumbents;
+    std::vector<std::pair<double,double>> gap_trajectory; // (seconds after start of solve, relative MIP gap)
+
+    int policy;
+    double target_gap;
+    double stability_sec;
+
+    bool all_decided() const;
+
+public:
+    IncumbentCallback(int policy, double target_gap, double stability_sec);
+
+    // watch requests before the next solve
+    void clear();
+    void watch(int request, IloNumVar p, const std::vector<std::pair<IloNumVar, std::vector<IloNumVar>>>& pickups);
+    void arm(clock::time_point start);
+
+    void invoke(const IloCplex::Callback::Context& context) override;
+
+    // answer of request i in the last incumbent and the time it was found after start of the solve
+    bool answer(int i, bool& accepted, double& pickup, double& answered) const;
+    int get_num_incumbents() const {return num_incumbents;}
+    double get_first_incumbent() const {return first_incumbent;}
+    double get_last_incumbent() const {return last_incumbent;}
+    const std::vector<std::pair<double,double>>& get_gap_trajectory() const {return gap_trajectory;}
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _REQUEST_STREAM_H
+#define _REQUEST_STREAM_H
+
+// lock-free ring buffer between exactly one producer and one consumer thread, N a power of two
+template<typename T, size_t N>
+class SpscQueue {
+private:
+    static_assert((N & (N - 1)) == 0, "capacity of SpscQueue has to be a power of two");
+    std::array<T, N> buffer;
+    alignas(64) std::atomic<size_t> head{0}; // next element to pop, written by the consumer only
+    alignas(64) std::atomic<size_t> tail{0}; // next free slot, written by the producer only
+
+public:
+    bool push(const T& value)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+            return false;
+        buffer[t & (N - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    bool empty() const
+    {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+    bool pop(T& value)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = buffer[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// a request revealed by the stream at time [min] of the simulation
+struct StreamRecord {
+    int request; // 0: a new request given by pickup and dropoff
+    double time; // < 0: at its arrival, i.e. when the rolling horizon reads it
+    DARPNode pickup;
+    DARPNode dropoff;
+};
+
+// Live reveals of requests read from stdin ("-"), a named pipe or file, or a Unix socket ("unix:<path>"),
+// one line per reveal: "request [time]" for a request of the instance or
+// "+ x_p y_p x_d y_d load service e_p l_p e_d l_d max_ride [time]" for a new request; without a time the request
+// is revealed when the rolling horizon reads it, on the clock of the simulation. A reader thread parses the lines into an SpscQueue
+class RequestStream {
+private:
+    SpscQueue<StreamRecord, 1024> queue;
+    int fd = -1;
+    std::thread reader;
+    std::atomic<bool> finished{false}; // the reader has seen the end of the stream
+    std::atomic<bool> stopping{false};
+    int invalid_lines = 0;
+
+    void read_loop();
+    void parse_line(const char* p, const char* end);
+
+public:
+    explicit RequestStream(const std::string& source);
+    ~RequestStream();
+    RequestStream(const RequestStream&) = delete;
+    RequestStream& operator=(const RequestStream&) = delete;
+
+    bool poll(StreamRecord& record);
+    bool at_end();
+};
+
+#endif
@@ -32,17 +32,154 @@ private:
     ARC* active_arc; 
     std::vector<ARC> fixed_edges;
     std::vector<ARC> all_fixed_edges;
+    // active nodes and arcs of the current solution indexed by event (0..2n-1), rebuilt by index_solution()
+    bool* in_solution;
+    std::pair<NODE,double>* solution_node;
+    ARC* solution_arc;
+    // progress of an accepted request at time time_passed
+    enum class Progress {waiting, picked_up, dropped_off};
 
     int num_milps = 1; // counter for milps
     const double epsilon = 1e-7; // fix variables in interval of +-epsilon
     double time_passed;
     int modify_obj;
     double denied_timeout = 0; // counts number of requests denied due to timeout
+    double kept_routes = 0; // re-solves without any solution, the last routes have been kept
     sec dur_model;
     sec dur_solve;
 
+    // check paths of the next new requests while CPLEX is solving
+    bool pipelined = false;
+    std::vector<int> prechecked_requests;
+
     friend class DelayIntegration<S>;
-    DelayIntegration<S>* delayIntegration;
+    DelayIntegration<S>* delayIntegration = nullptr;
+    DelayModel* delay_model = nullptr; // delays of the fixed edges and of the robustness scenarios
+    const ReplayDelay* replay = nullptr; // delay_model if a trace is replayed
+    DelayTrace trace; // records reveals and delays if open
+    // publish answers to new requests as soon as they are contained in an incumbent
+    IncumbentCallback<S>* incumbentCallback = nullptr;
+    // spend only as much of the time between new requests as needed
+    SolveBudget* budget = nullptr;
+    // accelerated offline simulation: scaled or deterministic limits instead of the real time between requests
+    bool simulation = false;
+    double sim_scale = 1; // factor on the time limits
+    double sim_ticks = 0; // deterministic ticks per second of time limit, wall-clock time limit if 0
+    double det_start = 0; // deterministic time stamp at the start of the last solve
+    long long sim_nodes = 0; // node limit per MILP, none if 0
+    int sim_seed = 1;
+    std::ofstream timings; // per-iteration timings to judge real-time feasibility
+    int sim_late = 0; // iterations that took longer than the real time between requests
+    // reveals of requests and advances of the horizon
+    EventQueue events;
+    // live reveals of the requests not known from the beginning, instead of become_known_array
+    RequestStream* stream = nullptr;
+    std::vector<bool> streamed; // revealed by the stream or known from the beginning
+    double stream_time = -DARPH_INFINITY; // reveal time of the last request from the stream
+    bool stream_ended = false;
+    int stream_slots = 0; // requests n-stream_slots+1, ..., n are reserved for new requests of the stream
+    int next_slot = 0;
+    // accumulate requests revealed within a window into one batch of new requests
+    BatchingPolicy* batching = nullptr;
+    std::vector<int> following_requests; // batch after the next new requests
+    double next_close = 0; // time at which the next new requests are revealed to the solver
+    double batch_close = 0; // the same for the current new requests
+    double last_close = 0; // time at which the last batch popped from the events is revealed to the solver
+    // requests whose pick-up lies beyond the lookahead horizon are accepted but enter the MILP only within the horizon
+    double lookahead = 0; // horizon [min], all requests enter the MILP at once if 0
+    double lookahead_reserve = 0.5; // share of the vehicles held in reserve for the requests beyond the horizon
+    std::vector<int> deferred; // accepted requests outside the MILP
+    std::vector<int> released; // new requests that have been accepted before
+    double deferred_requests = 0; // counts requests accepted beyond the horizon
+    double broken_commitments = 0; // counts requests accepted beyond the horizon but denied by the MILP
+    // answer new requests instantly by inserting them into the current routes
+    bool insertion = false;
+    std::vector<int> promised; // new requests answered by the insertion heuristic, the MILP has to keep their pick-up times
+    double promised_requests = 0; // counts requests answered by the insertion heuristic
+    double broken_promises = 0; // counts promised requests denied by the MILP
+    // tabu search on the current routes while the model is updated, its best routes are the MIP start
+    int tabu_threads = 0;
+    double tabu_time = 1; // time limit of the tabu search [s]
+    double tabu_standalone = 0; // below this time limit [s] CPLEX only completes the routes of the tabu search
+    bool tabu_found = false;
+    std::vector<std::vector<int>> tabu_routes;
+    std::vector<int> tabu_unserved;
+
+    // adaptive large neighborhood search for static instances
+    enum class Neighborhood {random, time, space, route};
+    static const int num_neighborhoods = 4;
+    int alns_workers = 0; // number of sub-MILPs solved in parallel
+    double alns_time = 600; // total time limit [s]
+    double alns_sub_time = 10; // time limit of the first MILP and of each sub-MILP [s]
+    double alns_share = 0.2; // share of requests freed by a neighborhood
+    // model of a destroy/repair worker: the full MILP in its own environment
+    struct SubMilp {
+        IloEnv env;
+        IloModel model;
+        IloCplex cplex;
+        IloNumArray B_val, d_val;
+        IloIntArray p_val, x_val;
+        IloNumVarArray B, x, p, d;
+        IloNumVar d_max;
+        IloRangeArray accept, serve_accepted, time_window_ub, time_window_lb;
+        IloArray<IloRangeArray> max_ride_time;
+        IloRangeArray travel_time, flow_preservation, excess_ride_time, fixed_B, fixed_x, pickup_delay;
+        IloRange num_tours;
+        IloObjective obj;
+        IloExpr obj1, obj2, obj3;
+        IloRangeArray neighborhood; // fixes the arcs outside of the neighborhood
+        Neighborhood type;
+        bool solved;
+        double objective;
+        std::vector<int> x_sol, p_sol;
+    };
+    // race differently configured copies of the MILP on each re-solve, each copy in its own environment
+    static const int num_race_configs = 5; // MIP emphasis balanced, feasibility, optimality, best bound, hidden feasibility
+    static constexpr const char* race_names[num_race_configs] = {"balanced", "feasibility", "optimality", "best bound", "hidden feasibility"};
+    int race_size = 0; // number of configurations raced, no racing if < 2
+    std::string race_file; // the model is cloned via this file
+    std::array<int,num_race_configs> race_wins = {};
+    std::array<int,num_race_configs> race_entries = {};
+    struct Racer {
+        IloEnv env;
+        IloModel model;
+        IloCplex cplex;
+        IloObjective obj;
+        IloNumVarArray vars;
+        IloRangeArray ranges;
+        IloCplex::Aborter aborter;
+        int config;
+        bool solved = false;
+        double objective;
+    };
+    // Monte Carlo evaluation of the routes against delays after each solve
+    int robustness_scenarios = 0; // no evaluation if 0
+    double robustness_time = 1; // latency budget of an evaluation [s]
+    int robustness_threads = 1;
+    std::vector<double> request_violation; // share of the scenarios of the last evaluation in which request i is served late
+    std::vector<double> vehicle_violation; // the same for the routes
+    double robustness_sum = 0; // violation probabilities of all evaluations
+    int robustness_runs = 0;
+    // robust planning: travel times of arcs are extended by a quantile of their sampled delays
+    double robust_quantile = 0; // no buffers if 0
+    int robust_scenarios = 100; // sampled delays per leg
+    std::unordered_map<uint64_t,double> delay_buffers; // buffer of each leg (from event, to event)
+    int buffered_arcs = 0;
+    double buffer_sum = 0;
+    struct RobustnessCount {
+        long scenarios = 0;
+        long any = 0; // scenarios with a violation
+        long time_window = 0, ride_time = 0, promise = 0;
+        std::vector<int> request, vehicle;
+    };
+    // time-window decomposition of large static instances
+    double static_time = 7200; // time limit of a static MILP [s]
+    double slice_length = 0; // length of a time slice [min], no decomposition if 0
+    double slice_overlap = 30; // requests up to this many minutes before or after a slice are solved with it [min]
+    int slice_threads = 1; // number of slices or clusters solved in parallel
+    // geographic clustering of static instances
+    int num_clusters = 0; // no clustering if 0
+    int cluster_rounds = 3; // rebalancing rounds of vehicles and requests between the clusters
     TerminalOutputFormatter<S>* tof;
 
 public:
@@ -52,6 +189,27 @@ public:
     ~RollingHorizon();
     // no copy/ move constructor or assignment/ move operator needed so far
 
+    void set_pipelined(bool p) {pipelined = p;}
+    void set_anytime(int policy, double target_gap, double stability_sec);
+    void set_budget(double min_share, double safety);
+    void set_batching(int policy, double window, int max_size, double max_delay, double slo);
+    void use_delay_model(DelayModel* model);
+    void set_delay_model(int type, double probability, double delay, double mu, double sigma, const std::string& file);
+    void set_replay(const std::string& file);
+    void set_record(const std::string& file);
+    void set_stream(const std::string& source, int slots = 0);
+    void set_simulation(double scale, double ticks, long long nodes, int seed, const std::string& timings_file);
+    void set_seed(int seed) {sim_seed = seed;}
+    void set_lookahead(double horizon, double reserve) {lookahead = horizon; lookahead_reserve = reserve;}
+    void set_insertion(bool ins) {insertion = ins;}
+    void set_race(int size);
+    void set_robustness(int scenarios, double time_limit, int threads);
+    void set_robust_planning(double quantile, int scenarios) {robust_quantile = quantile; robust_scenarios = scenarios;}
+    void set_tabu(int threads, double time_limit, double standalone) {tabu_threads = threads; tabu_time = time_limit; tabu_standalone = standalone;}
+    void set_alns(int workers, double time_limit, double sub_time, double share) {alns_workers = workers; alns_time = time_limit; alns_sub_time = sub_time; alns_share = share;}
+    void set_decomposition(double length, double overlap, int threads, double time_limit) {slice_length = length; slice_overlap = overlap; slice_threads = threads; static_time = time_limit;}
+    void set_clustering(int clusters, int rounds) {num_clusters = clusters; cluster_rounds = rounds;}
+
     // maps - after creating nodes and arcs!
     void create_maps(DARP& D, DARPGraph<S>& G);
     void update_maps(const std::vector<int>&, DARP& D, DARPGraph<S>& G);
@@ -59,8 +217,18 @@ public:
     // rolling horizon routines
     // before/ first solve
     void first_milp(bool accept_all, bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, IloEnv& env, IloModel& model, IloNumArray& B_val, IloNumArray& d_val, IloIntArray& p_val, IloIntArray& x_val, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, IloNumVarArray& d, IloNumVar& d_max, IloRangeArray& accept, IloRangeArray& serve_accepted, IloRangeArray& time_window_ub, IloRangeArray& time_window_lb, IloArray<IloRangeArray>& max_ride_time, IloRangeArray& travel_time, IloRangeArray& flow_preservation, IloRangeArray& excess_ride_time, IloRangeArray& fixed_B, IloRangeArray& fixed_x, IloRangeArray& pickup_delay, IloRange& num_tours, IloObjective& obj, IloExpr& obj1, IloExpr& obj2, IloExpr& obj3, const std::array<double,3>& w = {1,60,0.1});
+    void index_solution(DARPGraph<S>& G, IloNumArray& B_val, IloIntArray& x_val);
+    Progress request_progress(DARP& D, int i) const;
+    void set_active_event(int k);
     void query_solution(DARP& D, DARPGraph<S>& G, IloNumArray& B_val, IloIntArray& p_val, IloIntArray& x_val, const std::array<double,3>& w = {1,60,0.1});
     void update_request_sets();
+    void schedule_reveals(DARP& D);
+    double next_batch(DARP& D, std::vector<int>& batch);
+    bool pull_stream(DARP& D);
+    bool more_requests(const DARP& D) const;
+    bool reserve_check(DARP& D, int i) const;
+    int reserved_vehicles(const DARP& D) const;
+    void defer_requests(DARP& D);
     void erase_dropped_off(bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, IloEnv& env, IloModel& model, IloNumArray& B_val, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, IloRangeArray& accept, IloRangeArray& serve_accepted, IloRangeArray& excess_ride_time, IloRangeArray& fixed_B, IloRangeArray& fixed_x);
     void erase_denied(bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, IloEnv& env, IloModel& model, IloNumArray& B_val, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, IloNumVarArray& d, IloRangeArray& accept, IloRangeArray& serve_accepted, IloRangeArray& excess_ride_time, IloRangeArray& fixed_B, IloRangeArray& fixed_x);
     void erase_picked_up(DARP &D, DARPGraph<S>& G, IloEnv& env, IloModel& model, IloNumArray& B_val, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, IloRangeArray& accept, IloRangeArray& serve_accepted, IloRangeArray& fixed_B, IloRangeArray& fixed_x);
@@ -70,6 +238,57 @@ public:
     void update_graph_sets(bool consider_excess_ride_time, DARPGraph<S>& G, IloNumArray& B_val, IloNumArray& d_val, IloIntArray& p_val, IloIntArray& x_val); // only for num_milps > 1
     void get_solution_values(bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, IloCplex& cplex, IloNumArray& B_val, IloNumArray& d_val, IloIntArray& p_val, IloIntArray& x_val, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, IloNumVarArray& d, IloRangeArray& fixed_B);
     void traverse_routes(DARP& D, DARPGraph<S>& G, IloNumArray& B_val, IloIntArray& x_val, IloRangeArray& B);
+    void watch_requests(DARPGraph<S>& G, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, const std::vector<int>& requests);
+    double answer_time(DARP& D, int i, bool accepted) const;
+    bool fallback_solve(DARPGraph<S>& G, IloEnv& env, IloModel& model, IloCplex& cplex, IloIntArray& x_val, IloNumVarArray& x, IloNumVarArray& p, IloRangeArray& accept, double granted);
+    void keep_last_routes(bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, IloNumArray& B_val, IloNumArray& d_val, IloIntArray& p_val, IloIntArray& x_val, IloRangeArray& fixed_B);
+    void record_solve(IloCplex& cplex, bool solved, double window, double granted, uint64_t model_size);
+    void set_time_limit(IloCplex& cplex, double phi) const;
+    void record_timings(double window, double granted, bool solved);
+
+    // solver racing
+    void race_order(std::vector<int>& order) const;
+    bool race(DARP& D, DARPGraph<S>& G, IloEnv& env, IloCplex& cplex, IloNumVarArray& x, IloNumVarArray& p, double phi);
+    void print_race_summary() const;
+
+    // robustness against delays
+    void simulate_delays(DARP& D, const std::vector<std::vector<int>>& routes, const std::vector<int>& open, int scenario, std::vector<double>& begin, RobustnessCount& count) const;
+    void evaluate_robustness(DARP& D);
+    double arc_buffer(DARP& D, DARPGraph<S>& G, const ARC& a);
+
+    // insertion heuristic
+    void collect_routes(DARP& D, std::vector<std::vector<int>>& routes) const;
+    void link_routes(DARP& D, const std::vector<std::vector<int>>& routes);
+    int first_open(DARP& D, const std::vector<int>& route) const;
+    bool evaluate_insertion(DARP& D, const std::vector<int>& route, int open, int i, int pickup_gap, int dropoff_gap, double& cost, const std::array<double,3>& w, bool keep = false);
+    bool insert_request(DARP& D, int i, const std::array<double,3>& w = {1,60,0.1});
+    void answer_by_insertion(DARP& D, const std::array<double,3>& w = {1,60,0.1});
+
+    // tabu search
+    TabuSearch prepare_tabu_search(bool accept_all, DARP& D, const std::array<double,3>& w = {1,60,0.1});
+    void tabu_search(const TabuSearch& start);
+    bool tabu_start(DARPGraph<S>& G, IloEnv& env, IloCplex& cplex, IloNumVarArray& x, IloNumVarArray& p);
+
+    // adaptive large neighborhood search
+    void build_sub_milp(SubMilp& sub, bool accept_all, bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, const std::array<double,3>& w);
+    void incumbent_routes(DARPGraph<S>& G, const std::vector<int>& x_sol, std::vector<std::pair<ARC,int>>& active, std::vector<int>& route_of) const;
+    void select_neighborhood(Neighborhood type, DARP& D, const std::vector<int>& route_of, std::mt19937& gen, std::vector<bool>& freed_route) const;
+    bool alns(bool accept_all, bool consider_excess_ride_time, DARP& D, DARPGraph<S>& G, IloEnv& env, IloCplex& cplex, IloNumVarArray& x, IloNumVarArray& p, const std::array<double,3>& w);
+
+    // time-window decomposition
+    double earliest_pickup(const DARP& D, int i) const;
+    void partition_requests(DARP& D, std::vector<std::vector<int>>& slices, std::vector<std::vector<int>>& core) const;
+    void solve_slice(bool accept_all, bool consider_excess_ride_time, bool heuristic, const DARP& D, const std::vector<int>& requests, int vehicles, std::vector<std::vector<int>>& routes, const std::array<double,3>& w) const;
+    void solve_slices(bool accept_all, bool consider_excess_ride_time, bool heuristic, const DARP& D, const std::vector<std::vector<int>>& slices, const std::vector<int>& vehicles, const std::vector<bool>& todo, std::vector<std::vector<std::vector<int>>>& routes, const std::array<double,3>& w) const;
+    bool check_route(DARP& D, const std::vector<int>& route, bool keep);
+    bool stitch_route(DARP& D, std::vector<std::vector<int>>& vehicles, const std::vector<int>& route);
+    int complete_routes(bool accept_all, bool consider_excess_ride_time, DARP& D, const std::vector<std::vector<int>>& vehicles, const std::vector<int>& unplaced, const std::array<double,3>& w);
+    std::array<double,3> decompose(bool accept_all, bool consider_excess_ride_time, bool heuristic, DARP& D, const std::array<double,3>& w);
+
+    // geographic clustering
+    void cluster_requests(DARP& D, int k, std::vector<std::vector<int>>& clusters, std::vector<std::array<double,4>>& centroids) const;
+    void share_vehicles(int num_vehicles, const std::vector<std::vector<int>>& clusters, std::vector<int>& vehicles) const;
+    std::array<double,3> cluster(bool accept_all, bool consider_excess_ride_time, bool heuristic, DARP& D, const std::array<double,3>& w);
 
     // complete routine
     std::array<double,3> solve(bool accept_all, bool consider_excess_ride_time, bool dynamic, bool heuristic, DARP& D, DARPGraph<S>& G, const std::array<double,3>& w = {1,60,0.1});
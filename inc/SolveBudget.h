@@ -0,0 +1,40 @@
+#ifndef _SOLVE_BUDGET_H
+#define _SOLVE_BUDGET_H
+
+// Decide how much of the time window between two reveals of new requests is spent in CPLEX
+class SolveBudget {
+private:
+    // statistics of one solve
+    struct Iteration {
+        uint64_t model_size; // number of arcs
+        double window; // time until the next reveal minus time to update the model [s]
+        double granted; // time limit [s]
+        double used; // time spent in the solve [s]
+        double first_incumbent; // time to first incumbent [s], -1 if unknown
+        double last_incumbent; // time to last improving incumbent [s], -1 if unknown
+        double gap; // relative MIP gap at the end of the solve
+    };
+    std::vector<Iteration> history;
+
+    double cap; // never grant more than the time to answer a request
+    double min_share; // never grant less than this share of the window
+    double safety; // factor on the predicted time to converge
+    int lookback; // number of past iterations used for the prediction
+    double reserve; // unused time carried forward from earlier iterations
+    double total_granted;
+    double total_used;
+
+    double predict(uint64_t model_size) const;
+
+public:
+    SolveBudget(double cap, double min_share = 0.25, double safety = 3, int lookback = 5);
+
+    double grant(double window, uint64_t model_size);
+    void record(uint64_t model_size, double window, double granted, double used, double first_incumbent, double last_incumbent, double gap);
+    double draw_reserve(double min_time);
+    
+    double get_reserve() const {return reserve;}
+    void print_summary(const std::string& clock) const;
+};
+
+#endif
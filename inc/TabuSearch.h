@@ -0,0 +1,68 @@
+#ifndef _TABU_SEARCH_H
+#define _TABU_SEARCH_H
+
+// Tabu search by Cordeau and Laporte (2003) on the part of the routes that has not been driven yet
+class TabuSearch {
+private:
+    const DARP& D;
+    int n; // num_requests
+    int max_users; // number of users on board that the event-based graph can represent
+    double now; // the vehicles do not leave their anchors before now
+    std::array<double,3> w; // objective function weights as in RollingHorizon::solve()
+
+    // routes: fixed part (driven or started), anchor = last event of the fixed part, open part
+    std::vector<std::vector<int>> fixed;
+    std::vector<std::vector<int>> open;
+    std::vector<int> anchor_load;
+    std::vector<int> anchor_users;
+    std::vector<double> anchor_departure;
+    std::vector<double> departure_depot;
+    std::vector<int> unserved; // requests that are not served at all
+    std::vector<bool> must_serve; // accepted requests
+    std::vector<double> latest; // latest beginning of service, i.e. end of time window or communicated pick-up time plus delay
+    std::vector<double> fixed_departure; // departure at pick-ups in the fixed part of the routes
+
+    // violations and costs of the routes of the current solution
+    std::vector<DARPRoute> route;
+    std::vector<double> route_costs;
+    std::vector<double> schedule; // beginning of service of the last evaluated route
+
+    // penalties of load, duration, time window and ride time violations
+    double alpha = 1;
+    double beta = 1;
+    double gamma = 1;
+    double tau = 1;
+    const double delta = 0.5;
+
+    // best feasible solution
+    bool found = false;
+    double best_costs = DARPH_INFINITY;
+    std::vector<std::vector<int>> best_open;
+    std::vector<int> best_unserved;
+    int iterations = 0;
+
+    double evaluate(const std::vector<int>& events, int r, DARPRoute& violations);
+    double penalized(const DARPRoute& violations, double costs) const;
+    bool feasible(const DARPRoute& violations) const;
+    double best_insertion(int i, int r, std::vector<int>& events);
+    double solution_costs(bool& is_feasible) const;
+
+public:
+    TabuSearch(const DARP& D, int max_users, double now, const std::array<double,3>& w);
+
+    // initial solution
+    void add_route(const std::vector<int>& events, int open_from);
+    void add_unserved(int i) {unserved.push_back(i);}
+    void promise(int i, double pickup) {must_serve[i] = true; latest[i] = DARPH_MIN(latest[i], pickup);}
+    void accept(int i) {must_serve[i] = true;}
+
+    void run(double time_limit, unsigned int seed);
+
+    bool get_found() const {return found;}
+    double get_best_costs() const {return best_costs;}
+    int get_iterations() const {return iterations;}
+    void get_best_routes(std::vector<std::vector<int>>& routes) const;
+    const std::vector<int>& get_best_unserved() const {return best_unserved;}
+};
+
+#endif
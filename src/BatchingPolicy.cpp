@@ -0,0 +1,83 @@
+#include "DARPH.h"
+
+BatchingPolicy::BatchingPolicy(int policy, double window, int max_size, double max_delay, double slo)
+{
+    this->policy = policy;
+    this->window = DARPH_MIN(window, max_delay);
+    this->max_size = max_size;
+    this->max_delay = max_delay;
+    this->slo = slo;
+    increase = max_delay / 10;
+}
+
+double BatchingPolicy::close(const std::vector<std::pair<double,int>>& pending, std::vector<int>& batch) const
+{
+    ///
+    /// pending: requests that have not been revealed to the solver yet with their reveal times, sorted by reveal time
+    /// the batch starts with the first pending request and takes the following ones revealed within the window,
+    /// but at most max_size; returns the time at which the batch closes (when it is full or the window ends)
+    ///
+    const double first = pending.front().first;
+    const double length = get_length();
+    batch.clear();
+    for (const auto& r: pending)
+    {
+        // requests revealed at the same time are never split
+        if (r.first > first + length + DARPH_EPSILON || (max_size > 0 && int(batch.size()) >= max_size && r.first > first + DARPH_EPSILON))
+            break;
+        batch.push_back(r.second);
+    }
+    if (max_size > 0 && int(batch.size()) >= max_size)
+        return pending[batch.size() - 1].first;
+    return first + length;
+}
+
+void BatchingPolicy::record(double close, const std::vector<double>& reveals, double solve_time)
+{
+    Batch b = {close, int(reveals.size()), 0, 0, 0};
+    for (const auto& r: reveals)
+    {
+        b.sum_delay += close - r;
+        b.max_delay = DARPH_MAX(b.max_delay, close - r);
+    }
+    b.latency = b.max_delay * 60 + solve_time;
+    history.push_back(b);
+
+    // AIMD: halve the window if the latency target is missed, otherwise widen it a little
+    if (policy == DARPH_BATCH_SLO)
+    {
+        if (b.latency > slo)
+            window = window / 2;
+        else
+            window = DARPH_MIN(max_delay, window + increase);
+#if VERBOSE
+        std::cout << "Batching: latency " << b.latency << "s, next window " << window << " min" << std::endl;
+#endif
+    }
+}
+
+void BatchingPolicy::print_summary() const
+{
+    if (history.empty())
+        return;
+    int requests = 0;
+    int violations = 0;
+    double sum_delay = 0, max_delay = 0, sum_latency = 0, max_latency = 0;
+    for (const auto& b: history)
+    {
+        requests += b.size;
+        sum_delay += b.sum_delay;
+        max_delay = DARPH_MAX(max_delay, b.max_delay);
+        sum_latency += b.latency;
+        max_latency = DARPH_MAX(max_latency, b.latency);
+        if (b.latency > slo)
+            violations++;
+    }
+    const double span = history.back().close - history.front().close;
+    std::cout << MANJ_GREEN << "Batching: " << FORMAT_STOP << requests << " requests in " << history.size() << " re-optimizations (" << double(requests) / history.size() << " per batch";
+    if (span > DARPH_EPSILON)
+        std::cout << ", " << roundf(history.size() / span * 60 * 100) / 100 << " per hour";
+    std::cout << ")" << std::endl;
+    std::cout << MANJ_GREEN << "Batching delay: " << FORMAT_STOP << "avg " << roundf(sum_delay / requests * 60 * 100) / 100 << "s, max " << roundf(max_delay * 60 * 100) / 100 << "s" << std::endl;
+    std::cout << MANJ_GREEN << "Batch latency: " << FORMAT_STOP << "avg " << roundf(sum_latency / history.size() * 100) / 100 << "s, max " << roundf(max_latency * 100) / 100 << "s, " << violations << " batch(es) above " << slo << "s" << std::endl;
+}
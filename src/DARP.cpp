@@ -11,15 +11,7 @@ DARP::DARP(int n) : num_requests{n}, num_nodes{2 * n}
     max_route_duration = DARPH_INFINITY;
     planning_horizon = DARPH_INFINITY;
 
-    d = new double *[num_nodes + 1];
-    d[0] = new double[(num_nodes + 1) * (num_nodes + 1)];
-    for (int i = 1; i < num_nodes + 1; i++)
-        d[i] = d[i - 1] + (num_nodes + 1);
-
-    tt = new double *[num_nodes + 1];
-    tt[0] = new double[(num_nodes + 1) * (num_nodes + 1)];
-    for (int i = 1; i < num_nodes + 1; i++)
-        tt[i] = tt[i - 1] + (num_nodes + 1);
+    // d and tt are set up when the instance is read, as dense matrices or computed from coordinates
 
     nodes = new DARPNode[num_nodes + 1];
 
@@ -42,16 +34,14 @@ DARP::~DARP()
 {
     // Constructor fertig
 
-    delete[] d[0];
-    delete[] d;
-    delete[] tt[0];
-    delete[] tt;
+    delete mapped;
     delete[] become_known_array;
     delete[] nodes;
     delete[] next_array;
     delete[] pred_array;
     delete[] route_num;
     delete[] routed;
+    delete[] route;
 }
 
 void DARP::preprocess()
@@ -64,20 +54,9 @@ void DARP::preprocess()
 
     for (int i = 1; i <= n; ++i)
     {
-
-        if (nodes[i].start_tw < DARPH_EPSILON && nodes[i].end_tw >= planning_horizon)
-        {
-            nodes[i].end_tw = DARPH_MAX(0, nodes[n + i].end_tw - tt[i][n + i] - nodes[i].service_time);
-            nodes[i].start_tw = DARPH_MAX(0, nodes[n + i].start_tw - nodes[i].max_ride_time - nodes[i].service_time);
-            if (nodes[i].end_tw <= nodes[i].start_tw)
-            {
-                report_error("%s: Time window preprocessing at node %d leads to error in time windows.\n", __FUNCTION__, i);
-            }
-        }
-        if (nodes[n + i].start_tw < DARPH_EPSILON && nodes[n + i].end_tw >= planning_horizon)
+        if (!tighten_time_windows(i, nodes[i], nodes[n + i]))
         {
-            nodes[n + i].start_tw = nodes[i].start_tw + nodes[i].service_time + tt[i][n + i];
-            nodes[n + i].end_tw = nodes[i].end_tw + nodes[i].service_time + nodes[i].max_ride_time;
+            report_error("%s: Time window preprocessing at node %d leads to error in time windows.\n", __FUNCTION__, i);
         }
     }
 #if FILE_DEBUG
@@ -88,28 +67,136 @@ void DARP::preprocess()
 #endif
 }
 
+bool DARP::tighten_time_windows(int i, DARPNode& pickup, DARPNode& dropoff) const
+{
+    // the window of the non-critical vertex follows from the other one
+    const double travel_time = tt[i][num_requests + i];
+    if (pickup.start_tw < DARPH_EPSILON && pickup.end_tw >= planning_horizon)
+    {
+        pickup.end_tw = DARPH_MAX(0, dropoff.end_tw - travel_time - pickup.service_time);
+        pickup.start_tw = DARPH_MAX(0, dropoff.start_tw - pickup.max_ride_time - pickup.service_time);
+        if (pickup.end_tw <= pickup.start_tw)
+            return false;
+    }
+    if (dropoff.start_tw < DARPH_EPSILON && dropoff.end_tw >= planning_horizon)
+    {
+        dropoff.start_tw = pickup.start_tw + pickup.service_time + travel_time;
+        dropoff.end_tw = pickup.end_tw + pickup.service_time + pickup.max_ride_time;
+    }
+    return true;
+}
+
+void DARP::reserve_requests(int slots)
+{
+    ///
+    /// grow the instance by slots requests n+1, ..., n+slots that are filled by fill_request() when they arrive:
+    /// the drop-off of request i moves from node n+i to node n+slots+i, the empty slots wait at the depot
+    /// and are never known. d and tt are computed from the coordinates again, so only instance mode 1 is
+    /// supported; a tiled matrix is computed without tiles and a dense one is not compacted
+    ///
+    if (slots <= 0)
+        return;
+    if (instance_mode != 1)
+        report_error("%s: new requests need the coordinates of instance mode 1\n", __FUNCTION__);
+
+    const int n = num_requests;
+    const int m = n + slots;
+    DARPNode* grown = new DARPNode[2 * m + 1];
+    grown[DARPH_DEPOT] = nodes[DARPH_DEPOT];
+    for (int i = 1; i <= m; ++i)
+    {
+        grown[i] = (i <= n) ? nodes[i] : nodes[DARPH_DEPOT];
+        grown[m + i] = (i <= n) ? nodes[n + i] : nodes[DARPH_DEPOT];
+        grown[i].id = i;
+        grown[m + i].id = m + i;
+    }
+    double* known = new double[m];
+    std::copy(become_known_array, become_known_array + n, known);
+    std::fill(known + n, known + m, DARPH_INFINITY);
+
+    delete[] nodes;
+    delete[] next_array;
+    delete[] pred_array;
+    delete[] route_num;
+    delete[] routed;
+    delete[] become_known_array;
+    num_requests = m;
+    num_nodes = 2 * m;
+    nodes = grown;
+    next_array = new int[num_nodes + 1];
+    pred_array = new int[num_nodes + 1];
+    route_num = new int[num_nodes + 1];
+    routed = new bool[num_nodes + 1]();
+    become_known_array = known;
+
+    d.computed(nodes, num_nodes + 1, d.is_dense() ? DARPH_DISTANCE_DENSE : DARPH_DISTANCE_COMPUTED);
+    tt.alias(d);
+}
+
+bool DARP::fill_request(int i, const DARPNode& pickup, const DARPNode& dropoff)
+{
+    ///
+    /// store a new request in the reserved slot i with its time windows tightened as by preprocess();
+    /// the slot stays empty if the load exceeds the vehicle capacity or a time window is empty
+    ///
+    const int n = num_requests;
+    if (pickup.demand < 1 || pickup.demand > veh_capacity || pickup.start_tw > pickup.end_tw || dropoff.start_tw > dropoff.end_tw)
+        return false;
+    const DARPNode empty = nodes[i];
+    nodes[i] = pickup;
+    nodes[n + i] = dropoff;
+    nodes[i].id = i;
+    nodes[n + i].id = n + i;
+    for (const int k: {i, n + i})
+    {
+        d.place(nodes, k);
+        tt.place(nodes, k);
+    }
+    // the length of the critical time window
+    const bool outbound = nodes[i].start_tw < DARPH_EPSILON && nodes[i].end_tw >= planning_horizon;
+    nodes[i].tw_length = outbound ? nodes[n + i].end_tw - nodes[n + i].start_tw : nodes[i].end_tw - nodes[i].start_tw;
+    nodes[n + i].tw_length = nodes[i].tw_length;
+    if (!tighten_time_windows(i, nodes[i], nodes[n + i]))
+    {
+        nodes[i] = empty;
+        nodes[n + i] = empty;
+        nodes[n + i].id = n + i;
+        return false;
+    }
+    return true;
+}
+
 void DARP::read_file(std::string infile, std::string data_directory, std::string instance)
 {
     ///
     /// Currently reads file in format of the pr-set (Cordeau and Laporte, 2003).
     /// For another type of test instance pay attention to nodes[i].max_ride_time.
+    /// An instance compiled by darp_compile is loaded as it is, including its instance mode.
     ///
+    if (read_binary(infile))
+    {
+        check_demand();
+        compact_distances();
+        return;
+    }
+    source_file = infile;
 
     double temp_max_ride_time;
-    int i, j;
+    int i;
     double val;
 
-    std::ifstream file;
-    std::string line;
-    file.open(infile.c_str(), std::ios_base::in);
-    if (!file)
+    MappedFile file(infile);
+    if (!file.is_open())
         report_error("%s: file error\n", __FUNCTION__);
+    const char* p = file.begin();
+    const char* end = file.end();
 
     // Read first line of file, which contains the following data:
     // number of vehicles, number of nodes, maximum route duration, vehicle capacity, maximum ride time
-    getline(file, line);
-    std::istringstream f(line);
-    f >> num_vehicles >> num_nodes >> max_route_duration >> veh_capacity >> temp_max_ride_time;
+    if (!(parse_next(p, end, num_vehicles) && parse_next(p, end, num_nodes) && parse_next(p, end, max_route_duration)
+          && parse_next(p, end, veh_capacity) && parse_next(p, end, temp_max_ride_time)))
+        report_error("%s: header line of %s is incomplete\n", __FUNCTION__, infile.c_str());
+    skip_line(p, end);
 
     if (instance_mode == 1)
     {
@@ -124,9 +211,11 @@ void DARP::read_file(std::string infile, std::string data_directory, std::string
         i = 0;
         while (i <= num_nodes)
         {
-            std::getline(file, line);
-            std::istringstream iss(line);
-            iss >> nodes[i].id >> nodes[i].x >> nodes[i].y >> nodes[i].service_time >> nodes[i].demand >> nodes[i].start_tw >> nodes[i].end_tw;
+            if (!(parse_next(p, end, nodes[i].id) && parse_next(p, end, nodes[i].x) && parse_next(p, end, nodes[i].y)
+                  && parse_next(p, end, nodes[i].service_time) && parse_next(p, end, nodes[i].demand)
+                  && parse_next(p, end, nodes[i].start_tw) && parse_next(p, end, nodes[i].end_tw)))
+                report_error("%s: line of node %d of %s is incomplete\n", __FUNCTION__, i, infile.c_str());
+            skip_line(p, end);
             i++;
         }
         for (i = 1; i <= num_requests / 2; ++i)
@@ -151,9 +240,11 @@ void DARP::read_file(std::string infile, std::string data_directory, std::string
         i = 0;
         while (i <= num_nodes)
         {
-            std::getline(file, line);
-            std::istringstream iss(line);
-            iss >> nodes[i].id >> nodes[i].service_time >> nodes[i].demand >> nodes[i].start_tw >> nodes[i].end_tw >> nodes[i].max_ride_time;
+            if (!(parse_next(p, end, nodes[i].id) && parse_next(p, end, nodes[i].service_time)
+                  && parse_next(p, end, nodes[i].demand) && parse_next(p, end, nodes[i].start_tw)
+                  && parse_next(p, end, nodes[i].end_tw) && parse_next(p, end, nodes[i].max_ride_time)))
+                report_error("%s: line of node %d of %s is incomplete\n", __FUNCTION__, i, infile.c_str());
+            skip_line(p, end);
 #if VERBOSE
             std::cout << nodes[i].id << " " << nodes[i].service_time << " " << nodes[i].demand << " " << nodes[i].start_tw << " " << nodes[i].end_tw << " " << nodes[i].max_ride_time << std::endl;
 #endif
@@ -169,10 +260,69 @@ void DARP::read_file(std::string infile, std::string data_directory, std::string
         planning_horizon = max_route_duration;
     }
 
-    file.close();
+    check_demand();
+
+    // Memory for route array is allocated
+    route = new DARPRoute[num_vehicles];
+
+    // Create distance and travel time matrix
+    if (instance_mode == 1)
+    {
+        // rounded Euclidean distances, dense or computed on demand depending on distance_type
+        d.computed(nodes, num_nodes + 1, distance_type);
+        tt.alias(d);
+    }
+    else if (instance_mode == 2)
+    {
+        std::string path_to_costs = DARPCostsPath(data_directory, instance);
+        costs_file = path_to_costs;
+        d.dense(num_nodes + 1);
+        tt.dense(num_nodes + 1);
+        read_costs(path_to_costs);
+
+        const size_t size = size_t(num_nodes + 1) * (num_nodes + 1);
+        const double* dist = d.data();
+        double* time = tt.data();
+        // one pass over the contiguous matrices, no dependency between the entries
+        for (size_t k = 0; k < size; ++k)
+        {
+            val = 1.8246 * dist[k] + 2.3690; // based on linear regression with data = all completed rides (Jan, Feb 21)
+            // val = 2.3634 * dist[k] + 0.2086;   // night time (März - Sep 2021, 22-3:59h)
+            time[k] = roundf(val * 100) / 100;
+        }
+    }
+    compact_distances();
+#if FILE_DEBUG
+    printf("Distance matrices: %zu bytes\n", d.memory() + (tt.shares(d) ? 0 : tt.memory()));
+#endif
+
+    return;
+}
+
+size_t DARP::compare_distances(const DARP& other) const
+{
+    ///
+    /// compare the doubles returned by get() bit for bit, e.g. of a compact and of a double matrix
+    ///
+    if (other.num_nodes != num_nodes)
+        report_error("%s: instances with %d and %d nodes\n", __FUNCTION__, num_nodes, other.num_nodes);
+    size_t differ = 0;
+    for (int i = 0; i <= num_nodes; ++i)
+    {
+        for (int j = 0; j <= num_nodes; ++j)
+        {
+            const double values[4] = {d.get(i, j), other.d.get(i, j), tt.get(i, j), other.tt.get(i, j)};
+            differ += (memcmp(&values[0], &values[1], sizeof(double)) != 0);
+            differ += (memcmp(&values[2], &values[3], sizeof(double)) != 0);
+        }
+    }
+    return differ;
+}
 
+void DARP::check_demand() const
+{
     // check if requested load is greater than the vehicle capacity
-    for (i = 0; i <= num_requests; ++i)
+    for (int i = 0; i <= num_requests; ++i)
     {
         if (nodes[i].demand > veh_capacity)
         {
@@ -185,47 +335,71 @@ void DARP::read_file(std::string infile, std::string data_directory, std::string
             report_error("%s: Infeasible number of requested seats detected.\n", __FUNCTION__);
         }
     }
+}
 
-    // Memory for route array is allocated
-    route = new DARPRoute[num_vehicles];
+void DARP::compact_distances()
+{
+    ///
+    /// store d and tt in compact_format where this is exact, a matrix keeps its doubles otherwise
+    /// (e.g. distances with two decimals as float32, which are only exact as fixed-point)
+    ///
+    if (compact_format == DARPH_COMPACT_NONE || !d.is_dense())
+        return;
+    const bool shared = tt.shares(d);
+    const size_t before = d.memory() + (shared ? 0 : tt.memory());
+    d.compress(compact_format);
+    if (shared)
+        tt.alias(d);
+    else
+        tt.compress(compact_format);
+    const size_t after = d.memory() + (shared ? 0 : tt.memory());
 
-    // Create distance and travel time matrix
-    if (instance_mode == 1)
+    const char* format = (compact_format == DARPH_COMPACT_FLOAT) ? "float32" : "fixed16";
+    std::cout << "Compact distances: d " << (d.is_compact() ? format : "double") << ", tt " << (tt.is_compact() ? format : "double");
+    std::cout << " (" << before / 1024 << " kB -> " << after / 1024 << " kB)" << std::endl;
+}
+
+void DARP::read_costs(const std::string& path)
+{
+    ///
+    /// parse the (num_nodes+1) x (num_nodes+1) distance matrix d, one row per line;
+    /// the file is mapped into memory and large matrices are parsed by several threads,
+    /// each one on a range of rows
+    ///
+    MappedFile file(path);
+    if (!file.is_open())
+        report_error("%s: costs file error\n", __FUNCTION__);
+
+    const int rows = num_nodes + 1;
+    std::vector<const char*> row_begin(rows, file.end());
+    const char* p = file.begin();
+    for (int i = 0; i < rows && p < file.end(); ++i)
     {
-        for (i = 0; i <= num_nodes; ++i)
-        {
-            for (j = 0; j <= num_nodes; j++)
-            {
-                val = sqrt((nodes[i].x - nodes[j].x) * (nodes[i].x - nodes[j].x) + (nodes[i].y - nodes[j].y) * (nodes[i].y - nodes[j].y));
-                d[i][j] = roundf(val * 100) / 100;
-                tt[i][j] = d[i][j];
-            }
-        }
+        row_begin[i] = p;
+        skip_line(p, file.end());
     }
-    else if (instance_mode == 2)
-    {
-        std::string path_to_costs = data_directory + instance + "_c_a.txt";
 
-        file.open(path_to_costs.c_str(), std::ios_base::in);
-        if (!file)
-            report_error("%s: costs file error\n", __FUNCTION__);
-
-        for (i = 0; i < num_nodes + 1; ++i)
+    auto parse_rows = [&](int first, int last) {
+        for (int i = first; i < last; ++i)
         {
-            std::getline(file, line);
-            std::istringstream iss(line);
-            for (j = 0; j < num_nodes + 1; j++)
+            const char* q = row_begin[i];
+            double* row = d.data() + size_t(i) * rows;
+            for (int j = 0; j < rows; ++j)
             {
-                iss >> d[i][j];
-                val = 1.8246 * d[i][j] + 2.3690; // based on linear regression with data = all completed rides (Jan, Feb 21)
-                // val = 2.3634 * d[i][j] + 0.2086;   // night time (März - Sep 2021, 22-3:59h)
-                tt[i][j] = roundf(val * 100) / 100;
+                if (!parse_next(q, file.end(), row[j]))
+                    report_error("%s: row %d of %s has %d entries, expected %d\n", __FUNCTION__, i, path.c_str(), j, rows);
             }
         }
-        file.close();
-    }
-
-    return;
+    };
+
+    // below a few hundred rows the threads cost more than they save
+    const int threads = DARPH_MAX(1, DARPH_MIN(int(std::thread::hardware_concurrency()), rows / 256));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t)
+        workers.push_back(std::thread(parse_rows, t * rows / threads, (t + 1) * rows / threads));
+    parse_rows(0, rows / threads);
+    for (auto& worker: workers)
+        worker.join();
 }
 
 void DARP::transform_dynamic(double share_static_requests, double beta)
@@ -292,3 +466,68 @@ void DARP::transform_dynamic(double share_static_requests, double beta)
     known_requests = R;
     num_known_requests = rcardinality;
 }
+
+void DARP::make_static()
+{
+    for (int i = 1; i <= num_requests; ++i)
+    {
+        become_known_array[i - 1] = 0;
+        R.push_back(i);
+    }
+    last_static = num_requests;
+    rcardinality = R.size();
+    known_requests = R;
+    num_known_requests = rcardinality;
+}
+
+void DARP::extract(const DARP& D, const std::vector<int>& requests, int vehicles)
+{
+    ///
+    /// request requests[k] of D becomes request k+1 of this instance (constructed for requests.size() requests),
+    /// with the same depot and vehicles of the same type (vehicles of them), all requests are known from the beginning
+    ///
+    const int m = requests.size();
+    if (m != num_requests)
+        report_error("%s: %d requests extracted into an instance with %d requests.\n", __FUNCTION__, m, num_requests);
+    if (vehicles < 1 || vehicles > D.num_vehicles)
+        report_error("%s: %d vehicles extracted from an instance with %d vehicles.\n", __FUNCTION__, vehicles, D.num_vehicles);
+
+    instance_mode = D.instance_mode;
+    num_vehicles = vehicles;
+    max_route_duration = D.max_route_duration;
+    planning_horizon = D.planning_horizon;
+    veh_capacity = D.veh_capacity;
+
+    std::vector<int> original(num_nodes + 1);
+    original[DARPH_DEPOT] = DARPH_DEPOT;
+    for (int k = 1; k <= m; ++k)
+    {
+        original[k] = requests[k - 1];
+        original[m + k] = D.num_requests + requests[k - 1];
+    }
+    for (int k = 0; k <= num_nodes; ++k)
+        nodes[k] = D.nodes[original[k]];
+    if (!D.d.is_dense())
+    {
+        // same backend on the coordinates of the extracted nodes
+        d.computed(nodes, num_nodes + 1, D.d.get_type());
+        tt.alias(d);
+    }
+    else
+    {
+        d.dense(num_nodes + 1);
+        tt.dense(num_nodes + 1);
+        for (int k = 0; k <= num_nodes; ++k)
+        {
+            for (int l = 0; l <= num_nodes; ++l)
+            {
+                d.set(k, l, D.d[original[k]][original[l]]);
+                tt.set(k, l, D.tt[original[k]][original[l]]);
+            }
+        }
+    }
+
+    delete[] route;
+    route = new DARPRoute[num_vehicles];
+    make_static();
+}
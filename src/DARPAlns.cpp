@@ -0,0 +1,266 @@
+#include "DARPH.h"
+#include "RollingHorizon.h"
+
+template<int Q>
+void RollingHorizon<Q>::build_sub_milp(SubMilp& sub, bool accept_all, bool consider_excess_ride_time, DARP& D, DARPGraph<Q>& G, const std::array<double,3>& w)
+{
+    // the maps of variables are shared, hence the sub-MILPs are built one after another
+    first_milp(accept_all, consider_excess_ride_time, D, G, sub.env, sub.model, sub.B_val, sub.d_val, sub.p_val, sub.x_val, sub.B, sub.x, sub.p, sub.d, sub.d_max, sub.accept, sub.serve_accepted, sub.time_window_ub, sub.time_window_lb, sub.max_ride_time, sub.travel_time, sub.flow_preservation, sub.excess_ride_time, sub.fixed_B, sub.fixed_x, sub.pickup_delay, sub.num_tours, sub.obj, sub.obj1, sub.obj2, sub.obj3, w);
+    sub.cplex = IloCplex(sub.model);
+    sub.cplex.setOut(sub.env.getNullStream());
+    sub.cplex.setParam(IloCplex::Param::Simplex::Tolerances::Feasibility, 0.0001);
+    sub.cplex.setParam(IloCplex::Param::TimeLimit, alns_sub_time);
+    sub.cplex.setParam(IloCplex::Param::Threads, DARPH_MAX(1, int(std::thread::hardware_concurrency()) / alns_workers));
+    sub.x_sol.assign(G.acardinality, 0);
+    sub.p_sol.assign(D.rcardinality, 0);
+}
+
+template<int Q>
+void RollingHorizon<Q>::incumbent_routes(DARPGraph<Q>& G, const std::vector<int>& x_sol, std::vector<std::pair<ARC,int>>& active, std::vector<int>& route_of) const
+{
+    ///
+    /// active arcs of a solution with the index of their route, route_of[i] is the route of request i (-1 if denied)
+    ///
+    std::vector<ARC> depot_arcs;
+    std::unordered_map<NODE,ARC,HashFunction<Q>> successor;
+    for (const auto& a: G.A)
+    {
+        if (x_sol[amap.at(a)] > 0.9)
+        {
+            if (a[0] == G.depot)
+                depot_arcs.push_back(a);
+            else
+                successor[a[0]] = a;
+        }
+    }
+
+    active.clear();
+    route_of.assign(n+1, -1);
+    int r = 0;
+    for (const auto& a: depot_arcs)
+    {
+        ARC e = a;
+        active.push_back(std::make_pair(e, r));
+        while (e[1] != G.depot)
+        {
+            if (e[1][0] <= n)
+                route_of[e[1][0]] = r;
+            e = successor.at(e[1]);
+            active.push_back(std::make_pair(e, r));
+        }
+        r++;
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::select_neighborhood(Neighborhood type, DARP& D, const std::vector<int>& route_of, std::mt19937& gen, std::vector<bool>& freed_route) const
+{
+    ///
+    /// choose a seed request and the requests most related to it (by time, space or route),
+    /// all routes serving one of these requests are freed
+    ///
+    std::uniform_real_distribution<double> random(0, 1);
+    const int seed = D.R[std::uniform_int_distribution<int>(0, D.R.size() - 1)(gen)];
+    const int size = DARPH_MAX(1, int(alns_share * D.R.size()));
+
+    std::vector<std::pair<double,int>> relatedness;
+    for (const auto& i: D.R)
+    {
+        double score;
+        switch (type)
+        {
+            case Neighborhood::time:
+                score = DARPH_ABS(earliest_pickup(D, i) - earliest_pickup(D, seed));
+                break;
+            case Neighborhood::space:
+                score = D.d[i][seed] + D.d[n+i][n+seed];
+                break;
+            case Neighborhood::route:
+                score = (route_of[i] == route_of[seed]) ? 0 : 1 + random(gen);
+                break;
+            default:
+                score = random(gen);
+        }
+        relatedness.push_back(std::make_pair((i == seed) ? -1 : score, i));
+    }
+    std::sort(relatedness.begin(), relatedness.end());
+
+    for (int k = 0; k < size && k < int(relatedness.size()); ++k)
+    {
+        const int i = relatedness[k].second;
+        if (route_of[i] >= 0)
+            freed_route[route_of[i]] = true;
+    }
+}
+
+template<int Q>
+bool RollingHorizon<Q>::alns(bool accept_all, bool consider_excess_ride_time, DARP& D, DARPGraph<Q>& G, IloEnv& env, IloCplex& cplex, IloNumVarArray& x, IloNumVarArray& p, const std::array<double,3>& w)
+{
+    ///
+    /// improve the solution of the first MILP: each worker frees a neighborhood of related requests, fixes
+    /// all other arcs x_a to their incumbent value and solves the much smaller sub-MILP with a short time limit;
+    /// the workers run in parallel, the best improvement becomes the new incumbent and the neighborhoods
+    /// are chosen with weights adapted to their success (Ropke and Pisinger, 2006)
+    ///
+    const auto before = clock::now();
+    std::mt19937 gen(sim_seed);
+    std::array<double,num_neighborhoods> weight, calls, improvements;
+    weight.fill(1);
+    calls.fill(0);
+    improvements.fill(0);
+    const double reaction = 0.1;
+
+    // incumbent
+    double objective = cplex.getObjValue();
+    const double first_objective = objective;
+    std::vector<int> x_sol(G.acardinality, 0), p_sol(D.rcardinality, 0);
+    for (const auto& a: G.A)
+        x_sol[amap[a]] = (cplex.getValue(x[amap[a]]) > 0.9) ? 1 : 0;
+    for (const auto& i: D.R)
+        p_sol[rmap[i]] = (cplex.getValue(p[rmap[i]]) > 0.9) ? 1 : 0;
+    const std::vector<int> x_first = x_sol, p_first = p_sol;
+
+    std::vector<SubMilp> subs(alns_workers);
+    for (auto& sub: subs)
+        build_sub_milp(sub, accept_all, consider_excess_ride_time, D, G, w);
+
+    std::vector<std::pair<ARC,int>> active;
+    std::vector<int> route_of;
+    int rounds = 0;
+    while (sec(clock::now() - before).count() < alns_time)
+    {
+        rounds++;
+        incumbent_routes(G, x_sol, active, route_of);
+
+        for (auto& sub: subs)
+        {
+            // roulette wheel selection of the neighborhood
+            std::discrete_distribution<int> roulette(weight.begin(), weight.end());
+            sub.type = Neighborhood(roulette(gen));
+            calls[int(sub.type)]++;
+            std::vector<bool> freed_route(D.num_vehicles, false);
+            select_neighborhood(sub.type, D, route_of, gen, freed_route);
+
+            sub.neighborhood = IloRangeArray(sub.env);
+            for (const auto& e: active)
+            {
+                if (!freed_route[e.second])
+                    sub.neighborhood.add(IloRange(sub.env, 1, sub.x[amap[e.first]], 1));
+            }
+            sub.model.add(sub.neighborhood);
+
+            IloNumVarArray start_vars(sub.env);
+            IloNumArray start_vals(sub.env);
+            for (const auto& a: G.A)
+            {
+                start_vars.add(sub.x[amap[a]]);
+                start_vals.add(x_sol[amap[a]]);
+            }
+            for (const auto& i: D.R)
+            {
+                start_vars.add(sub.p[rmap[i]]);
+                start_vals.add(p_sol[rmap[i]]);
+            }
+            sub.cplex.addMIPStart(start_vars, start_vals);
+            start_vars.end();
+            start_vals.end();
+            sub.cplex.setParam(IloCplex::Param::TimeLimit, DARPH_MAX(1, DARPH_MIN(alns_sub_time, alns_time - sec(clock::now() - before).count())));
+        }
+
+        // repair: solve the sub-MILPs in parallel, each in its own environment
+        std::vector<std::thread> workers;
+        for (auto& sub: subs)
+        {
+            workers.push_back(std::thread([this, &sub, &G, &D]() {
+                sub.solved = sub.cplex.solve();
+                if (sub.solved)
+                {
+                    sub.objective = sub.cplex.getObjValue();
+                    for (const auto& a: G.A)
+                        sub.x_sol[amap.at(a)] = (sub.cplex.getValue(sub.x[amap.at(a)]) > 0.9) ? 1 : 0;
+                    for (const auto& i: D.R)
+                        sub.p_sol[rmap.at(i)] = (sub.cplex.getValue(sub.p[rmap.at(i)]) > 0.9) ? 1 : 0;
+                }
+            }));
+        }
+        for (auto& worker: workers)
+            worker.join();
+
+        // accept the best improvement, all sub-MILPs started from the same incumbent
+        SubMilp* best = nullptr;
+        for (auto& sub: subs)
+        {
+            bool improved = sub.solved && sub.objective < objective - DARPH_EPSILON;
+            weight[int(sub.type)] = (1 - reaction) * weight[int(sub.type)] + reaction * (improved ? 33 : 1);
+            if (improved)
+            {
+                improvements[int(sub.type)]++;
+                if (best == nullptr || sub.objective < best->objective)
+                    best = &sub;
+            }
+            sub.cplex.deleteMIPStarts(0, sub.cplex.getNMIPStarts());
+            sub.model.remove(sub.neighborhood);
+            sub.neighborhood.endElements();
+            sub.neighborhood.end();
+        }
+        if (best)
+        {
+            objective = best->objective;
+            x_sol = best->x_sol;
+            p_sol = best->p_sol;
+#if VERBOSE
+            std::cout << "ALNS round " << rounds << " (" << sec(clock::now() - before).count() << "s): objective " << objective << std::endl;
+#endif
+        }
+    }
+
+    for (auto& sub: subs)
+    {
+        sub.obj1.end();
+        sub.obj2.end();
+        sub.obj3.end();
+        sub.env.end();
+    }
+
+    std::cout << MANJ_GREEN << "ALNS: " << FORMAT_STOP << rounds << " rounds with " << alns_workers << " workers, objective " << first_objective << " -> " << objective << std::endl;
+    const char* names[num_neighborhoods] = {"random", "time", "space", "route"};
+    for (int k = 0; k < num_neighborhoods; ++k)
+        std::cout << "  " << names[k] << ": " << improvements[k] << "/" << calls[k] << " improving, weight " << weight[k] << std::endl;
+
+    // load the incumbent into the main model, CPLEX only has to complete it
+    auto load = [&](const std::vector<int>& x_start, const std::vector<int>& p_start, IloCplex::MIPStartEffort effort) {
+        IloNumVarArray start_vars(env);
+        IloNumArray start_vals(env);
+        for (const auto& a: G.A)
+        {
+            start_vars.add(x[amap[a]]);
+            start_vals.add(x_start[amap[a]]);
+        }
+        for (const auto& i: D.R)
+        {
+            start_vars.add(p[rmap[i]]);
+            start_vals.add(p_start[rmap[i]]);
+        }
+        cplex.addMIPStart(start_vars, start_vals, effort);
+        const bool solved = cplex.solve();
+        cplex.deleteMIPStarts(0, cplex.getNMIPStarts());
+        start_vars.end();
+        start_vals.end();
+        return solved;
+    };
+    cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, 0);
+    cplex.setParam(IloCplex::Param::TimeLimit, alns_sub_time);
+    bool solved = load(x_sol, p_sol, IloCplex::MIPStartRepair);
+    if (!solved)
+    {
+        // the solution of the first MILP is feasible, with its integer values fixed only the times are computed
+        std::cerr << "ALNS: incumbent not completed within " << alns_sub_time << "s, keeping the first solution" << std::endl;
+        cplex.setParam(IloCplex::Param::TimeLimit, static_time);
+        solved = load(x_first, p_first, IloCplex::MIPStartSolveFixed);
+    }
+    cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, 9223372036800000000);
+    return solved;
+}
+
+template class RollingHorizon<3>;
+template class RollingHorizon<6>;
@@ -0,0 +1,255 @@
+#include "DARPH.h"
+#include "RollingHorizon.h"
+
+template<int Q>
+void RollingHorizon<Q>::cluster_requests(DARP& D, int k, std::vector<std::vector<int>>& clusters, std::vector<std::array<double,4>>& centroids) const
+{
+    ///
+    /// k-means on the coordinates of pick-up and drop-off of the requests (k-means++ initialization),
+    /// so that a cluster contains trips between the same areas; fewer than k clusters if there are fewer
+    /// requests or distinct trips
+    ///
+    auto point = [&D, this](int i) {return std::array<double,4>{D.nodes[i].x, D.nodes[i].y, D.nodes[n+i].x, D.nodes[n+i].y};};
+    auto distance = [](const std::array<double,4>& a, const std::array<double,4>& b) {
+        double dist = 0;
+        for (int l = 0; l < 4; ++l)
+            dist += (a[l] - b[l]) * (a[l] - b[l]);
+        return dist;
+    };
+
+    std::mt19937 gen(1);
+    centroids.clear();
+    clusters.clear();
+    if (D.R.empty())
+        return;
+    k = DARPH_MIN(k, int(D.R.size()));
+    centroids.push_back(point(D.R[std::uniform_int_distribution<int>(0, D.R.size() - 1)(gen)]));
+    std::vector<double> closest(D.R.size());
+    while (int(centroids.size()) < k)
+    {
+        double total = 0;
+        for (unsigned int r = 0; r < D.R.size(); ++r)
+        {
+            closest[r] = DARPH_INFINITY;
+            for (const auto& c: centroids)
+                closest[r] = DARPH_MIN(closest[r], distance(point(D.R[r]), c));
+            total += closest[r];
+        }
+        // every trip is a centroid already
+        if (total <= 0)
+            break;
+        std::discrete_distribution<int> next(closest.begin(), closest.end());
+        centroids.push_back(point(D.R[next(gen)]));
+    }
+    k = centroids.size();
+
+    std::vector<int> assignment(D.R.size(), -1);
+    bool changed = true;
+    for (int iteration = 0; changed && iteration < 100; ++iteration)
+    {
+        changed = false;
+        for (unsigned int r = 0; r < D.R.size(); ++r)
+        {
+            int best = 0;
+            for (int c = 1; c < k; ++c)
+            {
+                if (distance(point(D.R[r]), centroids[c]) < distance(point(D.R[r]), centroids[best]))
+                    best = c;
+            }
+            if (best != assignment[r])
+            {
+                assignment[r] = best;
+                changed = true;
+            }
+        }
+        // move the centroids, an empty cluster keeps its centroid
+        std::vector<std::array<double,4>> sum(k, std::array<double,4>{0,0,0,0});
+        std::vector<int> size(k, 0);
+        for (unsigned int r = 0; r < D.R.size(); ++r)
+        {
+            for (int l = 0; l < 4; ++l)
+                sum[assignment[r]][l] += point(D.R[r])[l];
+            size[assignment[r]]++;
+        }
+        for (int c = 0; c < k; ++c)
+        {
+            for (int l = 0; size[c] > 0 && l < 4; ++l)
+                centroids[c][l] = sum[c][l] / size[c];
+        }
+    }
+
+    clusters.assign(k, std::vector<int>());
+    for (unsigned int r = 0; r < D.R.size(); ++r)
+        clusters[assignment[r]].push_back(D.R[r]);
+    for (int c = k - 1; c >= 0; --c)
+    {
+        if (clusters[c].empty())
+        {
+            clusters.erase(clusters.begin() + c);
+            centroids.erase(centroids.begin() + c);
+        }
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::share_vehicles(int num_vehicles, const std::vector<std::vector<int>>& clusters, std::vector<int>& vehicles) const
+{
+    // shares proportional to the number of requests (largest remainder), every cluster gets at least one vehicle
+    int total = 0;
+    for (const auto& cluster: clusters)
+        total += cluster.size();
+
+    vehicles.assign(clusters.size(), 1);
+    int assigned = clusters.size();
+    std::vector<std::pair<double,int>> remainder;
+    for (unsigned int c = 0; c < clusters.size(); ++c)
+    {
+        const double share = double(num_vehicles) * clusters[c].size() / total;
+        const int extra = DARPH_MIN(DARPH_MAX(0, int(share) - 1), num_vehicles - assigned);
+        vehicles[c] += extra;
+        assigned += extra;
+        remainder.push_back(std::make_pair(-(share - vehicles[c]), c));
+    }
+    std::sort(remainder.begin(), remainder.end());
+    for (unsigned int r = 0; assigned < num_vehicles; r = (r + 1) % remainder.size())
+    {
+        vehicles[remainder[r].second]++;
+        assigned++;
+    }
+}
+
+template<int Q>
+std::array<double,3> RollingHorizon<Q>::cluster(bool accept_all, bool consider_excess_ride_time, bool heuristic, DARP& D, const std::array<double,3>& w)
+{
+    ///
+    /// geographic decomposition of city-scale static instances: the requests are clustered by the coordinates of their
+    /// pick-ups and drop-offs and every cluster is solved with its share of the vehicles as a MILP of its own (in parallel);
+    /// the event-based graphs of the clusters are much smaller since the number of event nodes grows super-linearly
+    /// with the number of mutually compatible requests
+    /// a master step rebalances after each round: vehicles that a cluster does not use move to the clusters with denied
+    /// requests, and if no vehicle is left denied requests move to the next closest cluster; only changed clusters are solved again
+    /// (rounds within this one static solve, the re-solves of the rolling horizon are not clustered)
+    ///
+    const auto before = clock::now();
+    time_passed = 0;
+    all_denied.clear();
+
+    std::vector<std::vector<int>> clusters;
+    std::vector<std::array<double,4>> centroids;
+    cluster_requests(D, DARPH_MIN(num_clusters, D.num_vehicles), clusters, centroids);
+    const int k = clusters.size();
+    std::vector<int> vehicles;
+    share_vehicles(D.num_vehicles, clusters, vehicles);
+
+    std::vector<std::vector<std::vector<int>>> routes(k);
+    std::vector<bool> todo(k, true);
+    std::vector<bool> moved(n+1, false);
+    std::vector<std::vector<int>> denied(k);
+    int round = 0;
+    int moved_vehicles = 0, moved_requests = 0;
+    while (true)
+    {
+        solve_slices(accept_all, consider_excess_ride_time, heuristic, D, clusters, vehicles, todo, routes, w);
+
+        std::vector<int> spare(k);
+        for (int c = 0; c < k; ++c)
+        {
+            std::vector<bool> served(n+1, false);
+            for (const auto& route: routes[c])
+            {
+                for (const auto& e: route)
+                {
+                    if (e <= n)
+                        served[e] = true;
+                }
+            }
+            denied[c].clear();
+            for (const auto& i: clusters[c])
+            {
+                if (!served[i])
+                    denied[c].push_back(i);
+            }
+            spare[c] = vehicles[c] - routes[c].size();
+        }
+#if VERBOSE
+        for (int c = 0; c < k; ++c)
+            std::cout << "cluster " << c << ": " << clusters[c].size() << " requests, " << vehicles[c] << " vehicles (" << spare[c] << " unused), " << denied[c].size() << " denied" << std::endl;
+#endif
+        if (round++ == cluster_rounds)
+            break;
+
+        // master: vehicles go to the clusters with most denied requests
+        todo.assign(k, false);
+        std::vector<int> order(k);
+        for (int c = 0; c < k; ++c)
+            order[c] = c;
+        std::sort(order.begin(), order.end(), [&denied](int a, int b) {return denied[a].size() > denied[b].size();});
+        for (const auto& c: order)
+        {
+            if (denied[c].empty())
+                break;
+            // a cluster keeps at least one vehicle, even if it does not use it in this round
+            int donor = -1;
+            for (int o = 0; o < k; ++o)
+            {
+                if (o != c && spare[o] > 0 && vehicles[o] > 1 && (donor < 0 || spare[o] > spare[donor]))
+                    donor = o;
+            }
+            if (donor >= 0)
+            {
+                spare[donor]--;
+                vehicles[donor]--;
+                vehicles[c]++;
+                todo[c] = true;
+                moved_vehicles++;
+                continue;
+            }
+            // no vehicle left: requests go to the next closest cluster, once
+            for (const auto& i: denied[c])
+            {
+                if (moved[i])
+                    continue;
+                const std::array<double,4> p = {D.nodes[i].x, D.nodes[i].y, D.nodes[n+i].x, D.nodes[n+i].y};
+                int target = -1;
+                double best = DARPH_INFINITY;
+                for (int o = 0; o < k; ++o)
+                {
+                    double dist = 0;
+                    for (int l = 0; l < 4; ++l)
+                        dist += (p[l] - centroids[o][l]) * (p[l] - centroids[o][l]);
+                    if (o != c && dist < best)
+                    {
+                        best = dist;
+                        target = o;
+                    }
+                }
+                if (target < 0)
+                    break;
+                clusters[c].erase(std::find(clusters[c].begin(), clusters[c].end(), i));
+                clusters[target].push_back(i);
+                moved[i] = true;
+                todo[target] = true;
+                moved_requests++;
+            }
+        }
+        if (std::find(todo.begin(), todo.end(), true) == todo.end())
+            break;
+    }
+
+    std::vector<std::vector<int>> all_routes;
+    std::vector<int> unplaced;
+    for (int c = 0; c < k; ++c)
+    {
+        all_routes.insert(all_routes.end(), routes[c].begin(), routes[c].end());
+        unplaced.insert(unplaced.end(), denied[c].begin(), denied[c].end());
+    }
+    const int repaired = complete_routes(accept_all, consider_excess_ride_time, D, all_routes, unplaced, w);
+    dur_solve = clock::now() - before;
+    std::cout << MANJ_GREEN << "Clustering: " << FORMAT_STOP << k << " clusters, " << round << " round(s), " << moved_vehicles << " vehicle(s) and " << moved_requests << " request(s) moved, " << repaired << " request(s) inserted, total " << dur_solve.count() << "s" << std::endl;
+
+    std::array<double,3> obj_value = {total_routing_costs, n - answered_requests, total_excess_ride_time};
+    return obj_value;
+}
+
+template class RollingHorizon<3>;
+template class RollingHorizon<6>;
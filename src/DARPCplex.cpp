@@ -7,11 +7,12 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
     // We use this stringstream to create variable and constraint names
     std::stringstream name;
     
-    bool solved, flag;
+    bool solved;
     double phi; // timelimit 
-    int next_r;
+    double window; // time between new requests minus time to update the model
     double tunnr, tusnr; // time until next new requests and second next new requests
     const double notify_requests_min = double(notify_requests_sec) / 60;
+    int revealed = n; // requests revealed by the end, fewer if a request stream has ended early or has unused slots
     
     /// ***************Cplex API objects****************
     // Cplex model
@@ -46,6 +47,19 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
 
     /// ************************************************
 
+    // large static instances are solved slice by slice or cluster by cluster
+    if (!dynamic && slice_length > 0)
+        return decompose(accept_all, consider_excess_ride_time, heuristic, D, w);
+    if (!dynamic && num_clusters > 0)
+    {
+        if (D.instance_mode == 1)
+            return cluster(accept_all, consider_excess_ride_time, heuristic, D, w);
+        std::cerr << "Clustering needs the coordinates of instance mode 1, solving the instance as a whole." << std::endl;
+    }
+    // the re-solves of the rolling horizon are not decomposed: one MILP holds the fixed routes of all vehicles
+    if (dynamic && num_clusters > 0)
+        std::cerr << "Clustering is only implemented for static instances (--static), solving the dynamic instance as a whole." << std::endl;
+
     // create Graph
     check_paths(D);
     G.create_graph(D,f);
@@ -63,38 +77,10 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
         // std::cout << "notify_requests_sec: " << notify_requests_sec << std::endl;
         // std::cout << "notify_requests_min: " << notify_requests_min << std::endl;
 
-        next_r = D.last_static + 1;
-        tunnr = DARPH_INFINITY;
-        for (int i = next_r; i <= n; ++i)
-        {
-            if(std::find(D.known_requests.begin(), D.known_requests.end(), i) == D.known_requests.end())
-            {
-                // request i is not known yet
-                if (D.become_known_array[i-1] < tunnr)
-                {
-                    tunnr = D.become_known_array[i-1];
-                    next_r = i;
-                }
-            }
-        }
-
-        next_new_requests.push_back(next_r);
-        if (next_r == D.last_static+1)
-            D.last_static = next_r;
-        
-        // check if there are other requests which become known at the same time
-        for (int i=D.last_static+1; i<=n; ++i)
-        {
-            if(i != next_r)
-            {
-                if (DARPH_ABS(D.become_known_array[i-1] - tunnr) < DARPH_EPSILON)
-                {
-                    next_new_requests.push_back(i);
-                    if (i == D.last_static+1)
-                        D.last_static = i;
-                }
-            }
-        }
+        // requests revealed at the same time (or within the window of the batching policy) are new requests of the same MILP
+        schedule_reveals(D);
+        tunnr = next_batch(D, next_new_requests);
+        next_close = tunnr;
         time_passed = D.become_known_array[D.R[0]-1] + min(notify_requests_min, tunnr - D.become_known_array[D.R[0]-1]);
         phi = DARPH_MIN(notify_requests_sec, (tunnr - D.become_known_array[D.R[0]-1]) * 60);
         tunnr = tunnr - time_passed; 
@@ -102,21 +88,9 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
         // compute time until second next new request: tusnr 
         // when next new request arrives we can fix routes only for min(notify_requests_min,tusnr) minutes, i.e. until time_passed + tunnr + min(notify_requests_min,tusnr)
         // --> time for computation min(notify_requests_min,tusnr)
-        next_r = D.last_static + 1;
-        tusnr = DARPH_INFINITY;
-        for (int i=next_r; i<=n; ++i)
-        {
-            if(std::find(next_new_requests.begin(), next_new_requests.end(), i) == next_new_requests.end() && std::find(D.known_requests.begin(), D.known_requests.end(), i) == D.known_requests.end())
-            {
-                // request i is not known yet and no next new request
-                if (D.become_known_array[i-1] < tusnr)
-                {
-                    tusnr = D.become_known_array[i-1];
-                    next_r = i;
-                }
-            }
-        }
+        tusnr = next_batch(D, following_requests);
         tusnr = tusnr - (tunnr + time_passed);
+        events.push(time_passed + tunnr + min(notify_requests_min, tusnr), EventType::horizon);
     
         std::cout << tof->get_printable_header(num_milps, time_passed);
 #if VERBOSE 
@@ -165,26 +139,61 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
 #endif
          
         cplex.setParam(IloCplex::Param::Simplex::Tolerances::Feasibility, 0.0001);
+        if (simulation)
+        {
+            // reproducible runs: deterministic parallel mode and a fixed seed
+            cplex.setParam(IloCplex::Param::Parallel, IloCplex::Deterministic);
+            cplex.setParam(IloCplex::Param::RandomSeed, sim_seed);
+        }
         if (dynamic)
         {
             phi = phi - dur_model.count();
-            cplex.setParam(IloCplex::Param::TimeLimit, phi);
+            window = phi;
+            if (budget)
+                phi = budget->grant(window, G.acardinality);
+            set_time_limit(cplex, phi);
             //cplex.setParam(IloCplex::Param::Threads, 8);
         }
         else
-            cplex.setParam(IloCplex::Param::TimeLimit, 7200);
+            cplex.setParam(IloCplex::Param::TimeLimit, (alns_workers > 0) ? alns_sub_time : static_time);
         
+        if (incumbentCallback)
+        {
+            cplex.use(incumbentCallback, IloCplex::Callback::Context::Id::GlobalProgress);
+            incumbentCallback->clear();
+            watch_requests(G, B, x, p, D.R);
+            incumbentCallback->arm(before);
+        }
+
+        std::thread path_worker;
+        if (pipelined && dynamic && !next_new_requests.empty())
+            path_worker = std::thread(&RollingHorizon<Q>::precheck_new_paths, this, std::ref(D), D.R, next_new_requests, w[0], w[2]);
+
+        det_start = cplex.getDetTime();
         solved = cplex.solve();
         
+        if (path_worker.joinable())
+        {
+            path_worker.join();
+            prechecked_requests = next_new_requests;
+        }
+
+        // static instances: the first solution is improved by adaptive large neighborhood search
+        if (solved && !dynamic && alns_workers > 0)
+            solved = alns(accept_all, consider_excess_ride_time, D, G, env, cplex, x, p, w);
 
         dur_solve = clock::now() - before;
+        if (budget && dynamic)
+            record_solve(cplex, solved, window, phi, G.acardinality);
+        if (simulation && dynamic)
+            record_timings(window, phi, solved);
         
         if (solved)
         {
             // If CPLEX successfully solved the model, print the results
             get_solution_values(consider_excess_ride_time, D, G, cplex, B_val, d_val, p_val, x_val, B, x, p, d, fixed_B);
         
-            while (dynamic && solved && D.num_known_requests < n)
+            while (dynamic && solved && more_requests(D))
             {   
   
                 const auto before = clock::now();
@@ -193,7 +202,7 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
                 // std::cout << "time_passed " << time_passed << std::endl;
                 // std::cout << "tunnr " << tunnr << std::endl;
                 // std::cout << "tusnr " << tusnr << std::endl; 
-                time_passed += tunnr + min(notify_requests_min, tusnr); // +notify_requests_min wegen 30s bis answer an new request
+                time_passed = events.advance(EventType::horizon); // next new request(s) + notify_requests_min, since the answer to a new request takes up to 30s
                 // std::cout << "time_passed " << time_passed << std::endl;
                 phi = DARPH_MIN(notify_requests_sec, tusnr * 60);
                 // if (phi < notify_requests_sec)
@@ -220,7 +229,22 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
                 const auto after_erase_picked_up = clock::now();
 
                 new_requests = next_new_requests; // this can be done only AFTER sorting the requests into groups
+                batch_close = next_close;
                 next_new_requests.clear();
+                if (lookahead > 0)
+                    defer_requests(D);
+
+                // answer the new requests instantly, the MILP may only improve on these answers
+                // (before create_new_variables() which overwrites the next array when checking paths)
+                if (insertion)
+                    answer_by_insertion(D, w);
+                const auto after_answer_by_insertion = clock::now();
+
+                // improve the routes by tabu search while the model is updated
+                std::thread tabu_worker;
+                tabu_found = false;
+                if (tabu_threads > 0)
+                    tabu_worker = std::thread(&RollingHorizon<Q>::tabu_search, this, prepare_tabu_search(accept_all, D, w));
 
                 create_new_variables(heuristic, D, G, env, B, x, p, d, fixed_B, fixed_x, w);
                 const auto after_create_new_variables = clock::now();
@@ -232,52 +256,24 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
                 const sec dur_erase_dropped_off = after_erase_dropped_off - after_update_request_sets;
                 const sec dur_erase_denied = after_erase_denied - after_erase_dropped_off;
                 const sec dur_erase_picked_up = after_erase_picked_up - after_erase_denied;
-                const sec dur_create_new_variables = after_create_new_variables - after_erase_picked_up;
+                const sec dur_answer_by_insertion = after_answer_by_insertion - after_erase_picked_up;
+                const sec dur_create_new_variables = after_create_new_variables - after_answer_by_insertion;
                 const sec dur_update_milp = after_update_milp - after_create_new_variables;       
                 
                 // compute next new request and time limit
                 if (D.num_known_requests < n)
                 {
                     tunnr = tusnr - min(notify_requests_min,tusnr);
-                    next_new_requests.push_back(next_r);
-                    if (next_r == D.last_static+1)
-                        D.last_static = next_r;
-                    
-                    // check if there are other requests which become known at the same time
-                    for (int i=D.last_static+1; i<=n; ++i)
-                    {
-                        if(i != next_r)
-                        {
-                            if (DARPH_ABS(D.become_known_array[i-1] - (time_passed + tunnr)) < DARPH_EPSILON)
-                            {
-                                next_new_requests.push_back(i);
-                                if (i == D.last_static+1)
-                                    D.last_static = i;
-                            }
-                        }
-                    }
+                    next_new_requests = following_requests;
+                    next_close = time_passed + tunnr;
                     
-                    if (D.num_known_requests < n-1)
-                    {
-                        // compute second next new request 
-                        tusnr = DARPH_INFINITY;
-                        next_r = D.last_static + 1;
-                        for (int i=D.last_static+1; i<=n; ++i)
-                        {
-                            if(std::find(next_new_requests.begin(), next_new_requests.end(), i) == next_new_requests.end() && std::find(D.known_requests.begin(), D.known_requests.end(), i) == D.known_requests.end())
-                            {
-                                // requests i is not known yet and not a next new request
-                                if (D.become_known_array[i-1] < tusnr)
-                                {
-                                    tusnr = D.become_known_array[i-1];
-                                    next_r = i;
-                                }
-                            }
-                        }
+                    // compute second next new request(s)
+                    tusnr = next_batch(D, following_requests);
+                    if (!following_requests.empty())
                         tusnr = tusnr - (time_passed + tunnr); 
-                    }
                     else 
                         tusnr = notify_requests_min;
+                    events.push(time_passed + tunnr + min(notify_requests_min, tusnr), EventType::horizon);
                 }
                 
 
@@ -354,6 +350,8 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
                 //name << "MILP/MILP" << num_milps << ".lp";
                 //cplex.exportModel(name.str().c_str());
                 //name.str("");
+                if (tabu_worker.joinable())
+                    tabu_worker.join();
                 dur_model = clock::now() - before;
                 if (dur_model.count() > 15)
                 {
@@ -370,27 +368,87 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
                     std::cout << "erase_dropped_off: " << dur_erase_dropped_off.count() << "s\n"; 
                     std::cout << "erase_denied: " << dur_erase_denied.count() << "s\n"; 
                     std::cout << "erase_picked_up: " << dur_erase_picked_up.count() << "s\n"; 
+                    std::cout << "answer_by_insertion: " << dur_answer_by_insertion.count() << "s\n"; 
                     std::cout << "create_new_variables: " << dur_create_new_variables.count() << "s\n"; 
                     std::cout << "update_milp: " << dur_update_milp.count() << "s\n" << std::endl; 
                 }
                 
                 // optimization can only suceed if the time between two new requests is still greater than the time needed to load the new model
                 phi = phi - dur_model.count();
-                cplex.setParam(IloCplex::Param::TimeLimit, phi);
-                solved = cplex.solve();
+                window = phi;
+                if (budget)
+                    phi = budget->grant(window, G.acardinality);
+                set_time_limit(cplex, phi);
+
+                // start from the best routes of the tabu search, with too little time CPLEX only completes them
+                bool tabu_standalone_solve = false;
+                if (tabu_found && tabu_start(G, env, cplex, x, p) && phi < tabu_standalone)
+                {
+                    tabu_standalone_solve = true;
+                    cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, 0);
+                }
+                if (incumbentCallback)
+                {
+                    incumbentCallback->clear();
+                    watch_requests(G, B, x, p, new_requests);
+                    incumbentCallback->arm(before);
+                }
+
+                // the paths of the next new requests do not depend on the solution except for the requests picked up until then
+                std::thread path_worker;
+                if (pipelined && !next_new_requests.empty())
+                    path_worker = std::thread(&RollingHorizon<Q>::precheck_new_paths, this, std::ref(D), D.R, next_new_requests, w[0], w[2]);
+
+                det_start = cplex.getDetTime();
+                if (race_size > 1 && !tabu_standalone_solve)
+                    solved = race(D, G, env, cplex, x, p, phi);
+                else
+                    solved = cplex.solve();
+
+                if (path_worker.joinable())
+                {
+                    path_worker.join();
+                    prechecked_requests = next_new_requests;
+                }
+                if (tabu_standalone_solve)
+                    cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, 9223372036800000000);
+                if (cplex.getNMIPStarts() > 0)
+                    cplex.deleteMIPStarts(0, cplex.getNMIPStarts());
+
+                // no solution within the time limit: answer the new requests with the fallback instead of giving up
+                if (!solved && !accept_all)
+                    solved = fallback_solve(G, env, model, cplex, x_val, x, p, accept, phi);
                 dur_solve = clock::now() - before;
+                if (budget)
+                    record_solve(cplex, solved, window, phi, G.acardinality);
+                if (simulation)
+                    record_timings(window, phi, solved);
+                if (batching)
+                {
+                    std::vector<double> reveals;
+                    for (const auto& i: new_requests)
+                    {
+                        if (std::find(released.begin(), released.end(), i) == released.end())
+                            reveals.push_back(D.become_known_array[i-1]);
+                    }
+                    batching->record(batch_close, reveals, dur_solve.count());
+                }
 
                 if (solved)
                 {
                     update_graph_sets(consider_excess_ride_time, G, B_val, d_val, p_val, x_val);
                     get_solution_values(consider_excess_ride_time, D, G, cplex, B_val, d_val, p_val, x_val, B, x, p, d, fixed_B);
+                    if (robustness_scenarios > 0 && delay_model)
+                        evaluate_robustness(D);
                 }
                 else
                 {
+                    // also with accept_all, which skips the fallback: the simulation goes on with the last routes
                     std::cerr << "\n\nCplex error!\n";
                     std::cerr << "\tStatus: " << cplex.getStatus() << "\n";
                     std::cerr << "\tSolver status: " << cplex.getCplexStatus() << "\n";
-                    exit(1);
+                    keep_last_routes(consider_excess_ride_time, D, G, B_val, d_val, p_val, x_val, fixed_B);
+                    solved = true;
                 }
                 
                 // build new model and solve again   
@@ -399,28 +457,14 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
             if (dynamic)
             {
                 // query solution one last time to determine status of new requests
+                index_solution(G, B_val, x_val);
                 for (const auto& i : new_requests)
                 {
-                    flag = false;
                     if (p_val[rmap[i]] > 0.9)
                     { 
                         all_dropped_off.push_back(i);
                         // save active node to compute waiting time at pick-up node
-                        for (const auto& v: G.V_i[i])
-                        {
-                            for (const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    active_arc[i-1] = a;
-                                    active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                            if (flag)
-                                break;
-                        }
+                        set_active_event(i);
                     }
                     else
                     {
@@ -480,15 +524,30 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
             }
 
             if (dynamic)
-                answered_requests = n - all_denied.size();
+            {
+                revealed = D.num_known_requests;
+                answered_requests = revealed - all_denied.size();
+            }
             else
             {
                 answered_requests = n - cplex.getValue(obj2);
             }
 
-            std::cout << MANJ_GREEN << "Number denied requests: " << FORMAT_STOP << n - answered_requests << std::endl;
+            std::cout << MANJ_GREEN << "Number denied requests: " << FORMAT_STOP << revealed - answered_requests << std::endl;
+            if (insertion)
+            {
+                std::cout << MANJ_GREEN << "Requests answered by insertion: " << FORMAT_STOP << promised_requests << std::endl;
+                std::cout << MANJ_GREEN << "Broken promises: " << FORMAT_STOP << broken_promises << std::endl;
+            }
+            if (lookahead > 0)
+            {
+                std::cout << MANJ_GREEN << "Requests accepted beyond the horizon: " << FORMAT_STOP << deferred_requests << std::endl;
+                std::cout << MANJ_GREEN << "Broken commitments: " << FORMAT_STOP << broken_commitments << std::endl;
+            }
+            if (kept_routes > 0)
+                std::cout << MANJ_GREEN << "Re-solves without solution (last routes kept): " << FORMAT_STOP << kept_routes << std::endl;
 #if VERBOSE
-            std::cout << "Percentage denied requests: " << roundf(double(all_denied.size())/ n * 1000) / 1000 << std::endl;   
+            std::cout << "Percentage denied requests: " << roundf(double(all_denied.size())/ revealed * 1000) / 1000 << std::endl;   
             std::cout << "Percentage denied requests due to timeout: " << roundf(denied_timeout / double(all_denied.size()) * 100) / 100 << std::endl;    
 #endif
             if (dynamic)
@@ -496,9 +555,10 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
                 avg_time_to_answer = 0;
                 for (int i = 1; i<=n; ++i)
                 {
-                    avg_time_to_answer += time_to_answer[i-1];
+                    if (!stream || streamed[i])
+                        avg_time_to_answer += time_to_answer[i-1];
                 }
-                avg_time_to_answer = avg_time_to_answer / n;
+                avg_time_to_answer = avg_time_to_answer / revealed;
 #if VERBOSE
                 std::cout << "Average time to answer request: " << roundf(avg_time_to_answer * 100) / 100 << std::endl;   
 #endif
@@ -507,6 +567,23 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
             std::cout << "Total time to model: " << roundf(total_time_model * 100) / 100 << std::endl;
             std::cout << "Total time to model + solve: " << roundf(total_time_model_solve * 100) / 100 << std::endl; 
 #endif
+            if (budget)
+                budget->print_summary(!simulation ? "real time" : (sim_ticks > 0) ? "real time from deterministic ticks" : "real time, simulated time / scale");
+            if (batching)
+                batching->print_summary();
+            if (race_size > 1)
+                print_race_summary();
+            if (replay && replay->get_num_unused() > 0)
+                std::cout << MANJ_GREEN << "Recorded delays never replayed: " << FORMAT_STOP << replay->get_num_unused() << " of " << replay->get_num_delays() << std::endl;
+            if (buffered_arcs > 0)
+            {
+                std::cout << MANJ_GREEN << "Arcs with delay buffers: " << FORMAT_STOP << buffered_arcs << " (mean buffer " << buffer_sum / buffered_arcs << " min)" << std::endl;
+                std::cout << MANJ_GREEN << "Total time to model + solve: " << FORMAT_STOP << total_time_model_solve << "s" << std::endl;
+            }
+            if (robustness_runs > 0)
+                std::cout << MANJ_GREEN << "Average violation probability of the routes: " << FORMAT_STOP << robustness_sum / robustness_runs << std::endl;
+            if (simulation)
+                std::cout << MANJ_GREEN << "Iterations slower than real time: " << FORMAT_STOP << sim_late << " of " << num_milps << std::endl;
                      
         }
         else
@@ -539,389 +616,108 @@ std::array<double,3> RollingHorizon<Q>::solve(bool accept_all, bool consider_exc
     }
 #endif        
 
-    std::array<double,3> obj_value = {total_routing_costs, n - answered_requests, total_excess_ride_time};
+    std::array<double,3> obj_value = {total_routing_costs, revealed - answered_requests, total_excess_ride_time};
     return obj_value;
 }
 
 template<int Q>
-void RollingHorizon<Q>::query_solution(DARP& D, DARPGraph<Q>& G, IloNumArray& B_val, IloIntArray& p_val, IloIntArray& x_val, const std::array<double,3>& w)
-{      
-    bool flag;
+void RollingHorizon<Q>::index_solution(DARPGraph<Q>& G, IloNumArray& B_val, IloIntArray& x_val)
+{
+    /// one pass over the active arcs records for each pick-up and drop-off event of the current solution
+    /// the active event node, its active incoming arc and its time
+    for (int k = 0; k < 2*n; ++k)
+        in_solution[k] = false;
 
-    if (num_milps < 2)
+    for (const auto& a: G.A)
     {
-        for (const auto& i: D.R)
+        if (a[1] != G.depot && x_val[amap[a]] > 0.9)
         {
-            flag = false;
-            if (p_val[rmap[i]] > 0.9)
-            {
-                // determine dropped-off users until time time_passed
-                // see if drop-off until time time_passed is possible
-                if (time_passed >= D.nodes[n+i].end_tw)
-                {
-                    // drop-off time window has passed -> user must have been dropped off already
-                    dropped_off.push_back(i);
-                    // look for active pick-up node and active pick-up arc
-                    for (const auto& v: G.V_i[i])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                active_arc[i-1] = a;
-                                active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }
-                    // look for active drop-off node and active drop-off arc
-                    flag = false;
-                    for (const auto& v: G.V_i[n+i])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                active_arc[n+i-1] = a;
-                                active_node[n+i-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }
-                }
-                else if (time_passed >= D.nodes[n+i].start_tw)
-                {
-                    // we are within the time window
-                    // check if user has been dropped off yet
-                    for (const auto& v: G.V_i[n+i])
-                    {
-                        if (time_passed >= B_val[vmap[v]])
-                        {
-                            for(const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    dropped_off.push_back(i);
-                                    active_arc[n+i-1] = a;
-                                    active_node[n+i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }
-                    if (flag)
-                    {
-                        // user has been dropped off yet --> look for active pick-up node and active pick-up arc 
-                        flag = false;
-                        for (const auto& v: G.V_i[i])
-                        {
-                            for (const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    active_arc[i-1] = a;
-                                    active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                            if (flag)
-                                break;
-                        }
-                    }
-                    else
-                    {
-                        // we are within drop-off time window but user has not been dropped off yet
-                        // check if user has been picked up yet (Überschneidungen pick-up und drop-off time window möglich z.B. request 2 in a2-20)
-                        
-                        for (const auto& v: G.V_i[i])
-                        {
-                            if (time_passed >= B_val[vmap[v]])
-                            {
-                                for (const auto& a: G.delta_in[v])
-                                {
-                                    if (x_val[amap[a]] > 0.9)
-                                    {
-                                        picked_up.push_back(i);
-                                        active_arc[i-1] = a;
-                                        active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                        flag = true;
-                                        break;
-                                    }
-                                }
-                                if (flag)
-                                    break;
-                            } 
-                        }   
-                        if (!flag)
-                            seekers.push_back(i); 
-                    }
-                }
-                else if (time_passed >= D.nodes[i].end_tw)
-                {
-                    // user must have been picked-up already
-                    picked_up.push_back(i);
-                    for (const auto& v: G.V_i[i])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                active_arc[i-1] = a;
-                                active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }    
-                }
-                else if (time_passed >= D.nodes[i].start_tw)
-                {
-                    // we are within pick-up time window
-                    // check if user has been picked-up already
-                    for (const auto& v: G.V_i[i])
-                    {
-                        if (time_passed >= B_val[vmap[v]])
-                        {
-                            for (const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    picked_up.push_back(i);
-                                    active_arc[i-1] = a;
-                                    active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (flag)
-                            break;     
-                    }
-                    if (!flag)
-                    {
-                        // we are within pick-up time window but user has not been picked-up yet
-                        seekers.push_back(i);
-                    }
-                }
-                else
-                {
-                    // user's pick-up time window has not started yet
-                    seekers.push_back(i);
-                }
-
-                if (flag)  
-                {
-                    // user has been picked_up or dropped_off
-                    modify_obj += w[1];
-                }
-            }
-            else
-            {
-                denied.push_back(i);
-            } 
+            in_solution[a[1][0]-1] = true;
+            solution_arc[a[1][0]-1] = a;
+            solution_node[a[1][0]-1] = make_pair(a[1],B_val[vmap[a[1]]]);
         }
     }
+}
 
-    
-    
-    // first step: determine status of new_requests in solution: denied, dropped_off, picked-up, seeker
-    if (num_milps > 1)
+template<int Q>
+typename RollingHorizon<Q>::Progress RollingHorizon<Q>::request_progress(DARP& D, int i) const
+{
+    // event of node k has taken place until time time_passed
+    auto reached = [this](int k) { return in_solution[k-1] && time_passed >= solution_node[k-1].second; };
+
+    if (time_passed >= D.nodes[n+i].end_tw)
     {
-        for (const auto& i : new_requests)
-        {
-            flag = false;
-            if (p_val[rmap[i]] > 0.9)
-            { 
-                // check if drop-off until time time_passed is possible
-                if (time_passed >= D.nodes[n+i].end_tw)
-                {
-                    // drop-off time window has passed -> user must have been dropped off already
+        // drop-off time window has passed -> user must have been dropped off already
+        return Progress::dropped_off;
+    }
+    if (time_passed >= D.nodes[n+i].start_tw)
+    {
+        // we are within the drop-off time window, pick-up and drop-off time window may overlap (e.g. request 2 in a2-20)
+        if (reached(n+i))
+            return Progress::dropped_off;
+        if (reached(i))
+            return Progress::picked_up;
+        return Progress::waiting;
+    }
+    if (time_passed >= D.nodes[i].end_tw)
+    {
+        // user must have been picked-up already
+        return Progress::picked_up;
+    }
+    if (time_passed >= D.nodes[i].start_tw && reached(i))
+    {
+        // we are within pick-up time window and user has been picked-up already
+        return Progress::picked_up;
+    }
+    // user's pick-up time window has not started yet or user has not been picked-up yet
+    return Progress::waiting;
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_active_event(int k)
+{
+    if (in_solution[k-1])
+    {
+        active_arc[k-1] = solution_arc[k-1];
+        active_node[k-1] = solution_node[k-1];
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::query_solution(DARP& D, DARPGraph<Q>& G, IloNumArray& B_val, IloIntArray& p_val, IloIntArray& x_val, const std::array<double,3>& w)
+{      
+    index_solution(G, B_val, x_val);
+
+    // first step: determine status of the requests of the first MILP resp. of new_requests in solution: denied, dropped_off, picked-up, seeker
+    const std::vector<int>& requests = (num_milps < 2) ? D.R : new_requests;
+    for (const auto& i : requests)
+    {
+        if (p_val[rmap[i]] > 0.9)
+        { 
+            switch (request_progress(D, i))
+            {
+                case Progress::dropped_off:
                     dropped_off.push_back(i);
-                    // look for active pick-up node and active pick-up arc
-                    for (const auto& v: G.V_i[i])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                active_arc[i-1] = a;
-                                active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }
-                    // look for active drop-off node and active drop-off arc
-                    flag = false;
-                    for (const auto& v: G.V_i[n+i])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                active_arc[n+i-1] = a;
-                                active_node[n+i-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }
-                }
-                else if (time_passed >= D.nodes[n+i].start_tw)
-                {
-                    // we are within the drop-off time window
-                    // check if user has been dropped off yet
-                    for (const auto& v: G.V_i[n+i])
-                    {
-                        if (time_passed >= B_val[vmap[v]])
-                        {
-                            for(const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    dropped_off.push_back(i);
-                                    active_arc[n+i-1] = a;
-                                    active_node[n+i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }
-                    if (flag)
-                    {
-                        // user has been dropped off yet --> look for active pick-up node and active pick-up arc 
-                        flag = false;
-                        for (const auto& v: G.V_i[i])
-                        {
-                            for (const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    active_arc[i-1] = a;
-                                    active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                            if (flag)
-                                break;
-                        }
-                    }
-                    else
-                    {
-                        // we are within drop-off time window but user has not been dropped off yet
-                        // check if user has been picked up yet (Überschneidungen pick up und drop off time window möglich)
-                        
-                        for (const auto& v: G.V_i[i])
-                        {
-                            if (time_passed >= B_val[vmap[v]])
-                            {
-                                for (const auto& a: G.delta_in[v])
-                                {
-                                    if (x_val[amap[a]] > 0.9)
-                                    {
-                                        picked_up.push_back(i);
-                                        active_arc[i-1] = a;
-                                        active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                        flag = true;
-                                        break;
-                                    }
-                                }
-                                if (flag)
-                                    break;
-                            } 
-                        }
-                        if (!flag)
-                            seekers.push_back(i);   
-                    }
-                }
-                else if (time_passed >= D.nodes[i].end_tw)
-                {
-                    // user must have been picked-up already
+                    set_active_event(i);
+                    set_active_event(n+i);
+                    // user has been dropped-off --> update objective function
+                    modify_obj += w[1];
+                    break;
+                case Progress::picked_up:
                     picked_up.push_back(i);
-                    for (const auto& v: G.V_i[i])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                active_arc[i-1] = a;
-                                active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    }    
-                }
-                else if (time_passed >= D.nodes[i].start_tw)
-                {
-                    // we are within pick-up time window
-                    // check if user has been picked-up already
-                    for (const auto& v: G.V_i[i])
-                    {
-                        if (time_passed >= B_val[vmap[v]])
-                        {
-                            for (const auto& a: G.delta_in[v])
-                            {
-                                if (x_val[amap[a]] > 0.9)
-                                {
-                                    picked_up.push_back(i);
-                                    active_arc[i-1] = a;
-                                    active_node[i-1] = make_pair(v,B_val[vmap[v]]);
-                                    flag = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (flag)
-                            break;     
-                    }
-                    if (!flag)
-                    {
-                        // we are within pick-up time window but user has not been picked-up yet
-                        seekers.push_back(i);
-                    }
-                }
-                else
-                {
-                    // user's pick-up time window has not started yet
-                    seekers.push_back(i);
-                } 
-                
-
-                if (flag)
-                {
-                    // user has been picked-up or dropped-off
-                    // update objective function
+                    set_active_event(i);
+                    // user has been picked-up --> update objective function
                     modify_obj += w[1];
-                }
+                    break;
+                case Progress::waiting:
+                    seekers.push_back(i);
+                    break;
             }
-            else
-            {
-                denied.push_back(i);
-            } 
         }
+        else
+        {
+            denied.push_back(i);
+        } 
     }
 
     // second: check if status of any other users in R \ {new_request} = {all_picked_up, all_seekers} has changed
@@ -932,227 +728,35 @@ void RollingHorizon<Q>::query_solution(DARP& D, DARPGraph<Q>& G, IloNumArray& B_
     auto itr = std::begin(all_picked_up);
     while (itr != std::end(all_picked_up))
     {
-        flag = false;
-        
-        // determine dropped-off users until time time_passed
-        // see if drop-off until time time_passed is possible
-        if (time_passed >= D.nodes[n+(*itr)].end_tw)
+        // else: drop-off time window has not started yet or user has not been dropped off: remain in picked_up      
+        if (request_progress(D, *itr) == Progress::dropped_off)
         {
-            // drop-off time window has passed -> user must have been dropped off already
             dropped_off.push_back(*itr);
-            // look for active drop-off node and active drop-off arc
-            flag = false;
-            for (const auto& v: G.V_i[n+(*itr)])
-            {
-                for (const auto& a: G.delta_in[v])
-                {
-                    if (x_val[amap[a]] > 0.9)
-                    {
-                        active_arc[n+(*itr)-1] = a;
-                        active_node[n+(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                        flag = true;
-                        break;
-                    }
-                }
-                if (flag)
-                    break;
-            }
-        }
-        else if (time_passed >= D.nodes[n+(*itr)].start_tw)
-        {
-            // we are within the time window
-            // check if user has been dropped off yet
-            for (const auto& v: G.V_i[n+(*itr)])
-            {
-                if (time_passed >= B_val[vmap[v]])
-                {
-                    for(const auto& a: G.delta_in[v])
-                    {
-                        if (x_val[amap[a]] > 0.9)
-                        {
-                            dropped_off.push_back(*itr);
-                            active_arc[n+(*itr)-1] = a;
-                            active_node[n+(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                            flag = true;
-                            break;
-                        }
-                    }
-                }
-                if (flag)
-                    break;
-            }
-        }  
-        // else: drop-off time window has not started yet: remain in picked_up      
-        
-        if (flag)
+            set_active_event(n+(*itr));
             itr = all_picked_up.erase(itr);
+        }
         else
             ++itr;
     }
 
-
     itr = std::begin(all_seekers);
     while (itr != std::end(all_seekers))
     {
-        flag = false;
-
-        // determine dropped-off users until time time_passed
-        // see if drop-off until time time_passed is possible
-        if (time_passed >= D.nodes[n+(*itr)].end_tw)
+        Progress progress = request_progress(D, *itr);
+        if (progress == Progress::dropped_off)
         {
-            // drop-off time window has passed -> user must have been dropped off already
             dropped_off.push_back(*itr);
-            // look for active pick-up node and active pick-up arc
-            for (const auto& v: G.V_i[*itr])
-            {
-                for (const auto& a: G.delta_in[v])
-                {
-                    if (x_val[amap[a]] > 0.9)
-                    {
-                        active_arc[(*itr)-1] = a;
-                        active_node[(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                        flag = true;
-                        break;
-                    }
-                }
-                if (flag)
-                    break;
-            }
-            // look for active drop-off node and active drop-off arc
-            flag = false;
-            for (const auto& v: G.V_i[n+(*itr)])
-            {
-                for (const auto& a: G.delta_in[v])
-                {
-                    if (x_val[amap[a]] > 0.9)
-                    {
-                        active_arc[n+(*itr)-1] = a;
-                        active_node[n+(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                        flag = true;
-                        break;
-                    }
-                }
-                if (flag)
-                    break;
-            }
+            set_active_event(*itr);
+            set_active_event(n+(*itr));
         }
-        else if (time_passed >= D.nodes[n+(*itr)].start_tw)
+        else if (progress == Progress::picked_up)
         {
-            // we are within the time window
-            // check if user has been dropped off yet
-            for (const auto& v: G.V_i[n+(*itr)])
-            {
-                if (time_passed >= B_val[vmap[v]])
-                {
-                    for(const auto& a: G.delta_in[v])
-                    {
-                        if (x_val[amap[a]] > 0.9)
-                        {
-                            dropped_off.push_back(*itr);
-                            active_arc[n+(*itr)-1] = a;
-                            active_node[n+(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                            flag = true;
-                            break;
-                        }
-                    }
-                }
-                if (flag)
-                    break;
-            }
-            if (flag)
-            {
-                // user has been dropped off yet --> look for active pick-up node and active pick-up arc 
-                flag = false;
-                for (const auto& v: G.V_i[*itr])
-                {
-                    for (const auto& a: G.delta_in[v])
-                    {
-                        if (x_val[amap[a]] > 0.9)
-                        {
-                            active_arc[(*itr)-1] = a;
-                            active_node[(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                            flag = true;
-                            break;
-                        }
-                    }
-                    if (flag)
-                        break;
-                }
-            }
-            else
-            {
-                // we are within drop-off time window but user has not been dropped off yet
-                // check if user has been picked up yet (Überschneidungen pick up und drop off time window möglich)
-                
-                for (const auto& v: G.V_i[*itr])
-                {
-                    if (time_passed >= B_val[vmap[v]])
-                    {
-                        for (const auto& a: G.delta_in[v])
-                        {
-                            if (x_val[amap[a]] > 0.9)
-                            {
-                                picked_up.push_back(*itr);
-                                active_arc[(*itr)-1] = a;
-                                active_node[(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                                flag = true;
-                                break;
-                            }
-                        }
-                        if (flag)
-                            break;
-                    } 
-                } 
-            }
-        }
-        else if (time_passed >= D.nodes[*itr].end_tw)
-        {
-            // user must have been picked-up already
             picked_up.push_back(*itr);
-            for (const auto& v: G.V_i[*itr])
-            {
-                for (const auto& a: G.delta_in[v])
-                {
-                    if (x_val[amap[a]] > 0.9)
-                    {
-                        active_arc[(*itr)-1] = a;
-                        active_node[(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                        flag = true;
-                        break;
-                    }
-                }
-                if (flag)
-                    break;
-            }    
-        }
-        else if (time_passed >= D.nodes[*itr].start_tw)
-        {
-            // we are within pick-up time window
-            // check if user has been picked-up already
-            for (const auto& v: G.V_i[*itr])
-            {
-                if (time_passed >= B_val[vmap[v]])
-                {
-                    for (const auto& a: G.delta_in[v])
-                    {
-                        if (x_val[amap[a]] > 0.9)
-                        {
-                            picked_up.push_back(*itr);
-                            active_arc[(*itr)-1] = a;
-                            active_node[(*itr)-1] = make_pair(v,B_val[vmap[v]]);
-                            flag = true;
-                            break;
-                        }
-                    }
-                }
-                if (flag)
-                    break;     
-            }
-        // if (!flag): we are within pick-up time window but user has not been picked-up yet: remain in seekers
+            set_active_event(*itr);
         }
-        // else: pick-up time window has not started yet: remain in seekers
+        // else: user has not been picked-up yet: remain in seekers
 
-        if (flag)
+        if (progress != Progress::waiting)
         {
             itr = all_seekers.erase(itr);
             modify_obj += w[1];
@@ -1911,7 +1515,9 @@ void RollingHorizon<Q>::create_new_variables(bool heuristic, DARP& D, DARPGraph<
     // We use this stringstream to create variable and constraint names
     std::stringstream name;
 
-    check_new_paths(D, w[0], w[1], w[2]);
+    // in pipelined mode the paths between new requests and all requests known during the last solve have been checked already
+    check_new_paths(D, w[0], w[1], w[2], pipelined && prechecked_requests == new_requests);
+    prechecked_requests.clear();
     if (heuristic)
     {
         choose_paths(10, 0.25);  // min(10, 0.25 * num_feas_paths) paths allowed
@@ -1986,7 +1592,7 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
 
     // fix variable B_w for new fixed edges 
     if(delayIntegration) {
-        delayIntegration->incorporate_delay(name, env, model, B, fixed_B, fixed_edges, active_node, vmap, epsilon, n); 
+        delayIntegration->incorporate_delay(name, D, env, model, B, fixed_B, fixed_edges, active_node, vmap, epsilon, n); 
     }  
 
     else{
@@ -2031,7 +1637,7 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
         }
     }
     
-    // fixed variables p_i = 1 for all i in seekers
+    // fixed variables p_i = 1 for all i in seekers and for the new requests accepted by the insertion heuristic
     if (!accept_all)
     {
         for (const auto& i: seekers)
@@ -2041,6 +1647,23 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
             model.add(accept[rmap[i]]);
             name.str("");
         }
+        for (const auto& i: promised)
+        {
+            name << "accept_" << i;
+            accept[rmap[i]] = IloRange(env,1,p[rmap[i]],1,name.str().c_str()); 
+            model.add(accept[rmap[i]]);
+            name.str("");
+        }
+        // requests accepted beyond the lookahead horizon
+        for (const auto& i: released)
+        {
+            if (std::find(promised.begin(), promised.end(), i) != promised.end())
+                continue;
+            name << "accept_" << i;
+            accept[rmap[i]] = IloRange(env,1,p[rmap[i]],1,name.str().c_str()); 
+            model.add(accept[rmap[i]]);
+            name.str("");
+        }
     }
 
     // pick-up time communicated to user may not be delayed by more than pickup_delay minutes
@@ -2088,6 +1711,26 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
             model.add(pickup_delay[vinmap[v]]);
         }   
     }
+
+    // the pick-up time communicated by the insertion heuristic is a promise, too
+    for (const auto& i : promised)
+    {
+        for (const auto& v: G.V_i_new[i])
+        {   
+            if constexpr (Q==3)
+                name << "pickup_delay_B_(" << v[0] << "," << v[1] << "," << v[2] << ")";
+            else
+                name << "pickup_delay_B_(" << v[0] << "," << v[1] << "," << v[2] << "," << v[3] << "," << v[4] << "," << v[5] << ")"; 
+            for (const auto& a: G.delta_in_new[v])
+            {
+                expr += x[amap[a]];
+            }
+            pickup_delay[vinmap[v]] = IloRange(env, 0, -B[vmap[v]] + (1-expr) * D.nodes[i].end_tw + expr * (communicated_pickup[i-1] + pickup_delay_param), IloInfinity, name.str().c_str());
+            expr.clear();
+            name.str("");
+            model.add(pickup_delay[vinmap[v]]);
+        }   
+    }
     
     //std::cout << "modify obj " << modify_obj << std::endl;
     // update objective function
@@ -2273,6 +1916,19 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
     }
     num_tours.setExpr(expr);
     expr.clear();
+    // the vehicles held in reserve for the requests accepted beyond the lookahead horizon are not open to the MILP
+    if (deferred.empty())
+        num_tours.setUB(D.num_vehicles);
+    else
+    {
+        int departed = 0;
+        for (const auto& a: all_fixed_edges)
+        {
+            if (a[0] == G.depot)
+                departed++;
+        }
+        num_tours.setUB(DARPH_MAX(departed, D.num_vehicles - reserved_vehicles(D)));
+    }
     
 
     // travel time arc a
@@ -2280,6 +1936,8 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
     travel_time.add(G.num_new_arcs, IloRange());
     for (const auto& a: G.A_new)
     {
+        // travel time plus the delay buffer of robust planning
+        const double t = G.t[a] + arc_buffer(D, G, a);
         if constexpr (Q==3)
             name << "travel_time_(" << a[0][0] << "," << a[0][1] << "," << a[0][2] << "),(" << a[1][0] << "," << a[1][1] << "," << a[1][2] << ")";
         else
@@ -2289,20 +1947,20 @@ void RollingHorizon<Q>::update_milp(bool accept_all, bool consider_excess_ride_t
             // check if node a[0] has been reached already
             if ((a[0][0] <= n && std::find(all_picked_up.begin(), all_picked_up.end(), a[0][0]) != all_picked_up.end())||(a[0][0] > n && std::find(all_dropped_off.begin(), all_dropped_off.end(), a[0][0] - n) != all_dropped_off.end()))
             {
-                expr = -B[vmap[a[1]]] + time_passed + D.nodes[a[0][0]].service_time + G.t[a] - (time_passed - D.nodes[a[1][0]].start_tw + G.t[a] + D.nodes[a[0][0]].service_time) * (1 - x[amap[a]]);
+                expr = -B[vmap[a[1]]] + time_passed + D.nodes[a[0][0]].service_time + t - (time_passed - D.nodes[a[1][0]].start_tw + t + D.nodes[a[0][0]].service_time) * (1 - x[amap[a]]);
                 travel_time[amap[a]] = IloRange(env,expr,0,name.str().c_str());
                 model.add(travel_time[amap[a]]);
             }
             else
             {
-                expr = -B[vmap[a[1]]] + B[vmap[a[0]]] + D.nodes[a[0][0]].service_time + G.t[a] - (D.nodes[a[0][0]].end_tw - D.nodes[a[1][0]].start_tw + G.t[a] + D.nodes[a[0][0]].service_time) * (1 - x[amap[a]]);
+                expr = -B[vmap[a[1]]] + B[vmap[a[0]]] + D.nodes[a[0][0]].service_time + t - (D.nodes[a[0][0]].end_tw - D.nodes[a[1][0]].start_tw + t + D.nodes[a[0][0]].service_time) * (1 - x[amap[a]]);
                 travel_time[amap[a]] = IloRange(env,expr,0,name.str().c_str());
                 model.add(travel_time[amap[a]]);
             }
         }
         else
         {
-            expr = -B[vmap[a[1]]] + G.t[a] * x[amap[a]];
+            expr = -B[vmap[a[1]]] + t * x[amap[a]];
             travel_time[amap[a]] = IloRange(env,expr,-time_passed,name.str().c_str());
             model.add(travel_time[amap[a]]);
         }
@@ -2778,21 +2436,22 @@ void RollingHorizon<Q>::first_milp(bool accept_all, bool consider_excess_ride_ti
     model.add(num_tours);
     expr.clear();
     
-    // travel time arc a 
+    // travel time arc a (plus the delay buffer of robust planning)
     for (const auto& a: G.A)
     {   
+        const double t = G.t[a] + arc_buffer(D, G, a);
         if constexpr (Q==3)
             name << "travel_time_(" << a[0][0] << "," << a[0][1] << "," << a[0][2] << "),(" << a[1][0] << "," << a[1][1] << "," << a[1][2] << ")";
         else
             name << "travel_time_(" << a[0][0] << "," << a[0][1] << "," << a[0][2] << "," << a[0][3] << "," << a[0][4] << "," << a[0][5] << "),(" << a[1][0] << "," << a[1][1] << "," << a[1][2] << "," << a[1][3] << "," << a[1][4] << "," << a[1][5] << ")";
         if (a[0] != G.depot)
         {
-            expr = -B[vmap[a[1]]] + B[vmap[a[0]]] + D.nodes[a[0][0]].service_time + G.t[a] - (D.nodes[a[0][0]].end_tw - D.nodes[a[1][0]].start_tw + G.t[a] + D.nodes[a[0][0]].service_time) * (1 - x[amap[a]]);
+            expr = -B[vmap[a[1]]] + B[vmap[a[0]]] + D.nodes[a[0][0]].service_time + t - (D.nodes[a[0][0]].end_tw - D.nodes[a[1][0]].start_tw + t + D.nodes[a[0][0]].service_time) * (1 - x[amap[a]]);
             travel_time[amap[a]] = IloRange(env,expr,0,name.str().c_str());
         }
         else
         {
-            expr = -B[vmap[a[1]]] + G.t[a] * x[amap[a]];
+            expr = -B[vmap[a[1]]] + t * x[amap[a]];
             travel_time[amap[a]] = IloRange(env,expr,-time_passed,name.str().c_str());
         }
         expr.clear();
@@ -2900,115 +2559,357 @@ void RollingHorizon<Q>::first_milp(bool accept_all, bool consider_excess_ride_ti
 template<int Q>
 void RollingHorizon<Q>::traverse_routes(DARP& D, DARPGraph<Q>& G, IloNumArray& B_val, IloIntArray& x_val, IloRangeArray& fixed_B)
 {
-    int terminal_width = tof->get_current_terminal_width();
+    // query the terminal width once, the formatter reuses it for every event block
+    tof->get_current_terminal_width();
 
     // output solution we have so far
-    bool flag;
     int route_count = 0;    
     int current;
+    D.next_array[DARPH_DEPOT] = DARPH_DEPOT; // no routes unless a vehicle leaves the depot
 
-    std::vector<ARC> cycle_arcs;
-    std::vector<ARC> cycle;
-    ARC b = {};
+    // index the active arcs by their tail so that each route is walked with one lookup per event
+    std::vector<ARC> depot_arcs;
+    std::unordered_map<NODE,ARC,HashFunction<Q>> successor;
+    successor.reserve(2*D.rcardinality + D.num_vehicles);
     
     for (const auto& a: G.A)
     {
         if (x_val[amap[a]] > 0.9)
-            cycle_arcs.push_back(a);
+        {
+            if (a[0] == G.depot)
+                depot_arcs.push_back(a);
+            else
+                successor[a[0]] = a;
+        }
     }
 
-    while (!cycle_arcs.empty())
+    for (const auto& a: depot_arcs)
     {
-        flag = false;
-        for (const auto& a: cycle_arcs)
+        std::stringstream vehicle_block;
+        tof->reset_event_char_counter();
+
+        current = a[1][0];
+        D.route[route_count].start = current;
+        D.route[route_count].has_customers = true;
+        D.routed[current] = true;
+        D.route_num[current] = route_count;
+        if (route_count == 0)
         {
-            tof->reset_event_char_counter();
-            if (a[0] == G.depot)
+            D.next_array[DARPH_DEPOT] = -current;
+            D.pred_array[current] = DARPH_DEPOT;
+        }
+        else
+        {
+            D.next_array[D.route[route_count-1].end] = -current;
+            D.pred_array[current] = -D.route[route_count-1].end;
+        }
+
+        // follow the successor of each event until the vehicle returns to the depot
+        int passengers_in_vehicle = 0;
+        NODE v = a[1];
+        while (v != G.depot)
+        {
+            const ARC& f = successor.at(v);
+            auto time = B_val[vmap[v]];
+
+            if(time < time_passed) {
+                if(v[0] < n)
+                    passengers_in_vehicle++;
+                else
+                    passengers_in_vehicle--;
+            }
+
+            vehicle_block << tof->get_printable_event_block(v[0], time, time_passed, n);
+            D.nodes[v[0]].beginning_service = time;
+                    
+            if (f[1] != G.depot)
             {
-                std::stringstream vehicle_block;
-                b = a;
-                cycle_arcs.erase(std::remove(cycle_arcs.begin(), cycle_arcs.end(), a), cycle_arcs.end());
-                
-                current = b[1][0];
-                D.route[route_count].start = current;
-                D.route[route_count].has_customers = true;
+                D.next_array[current] = f[1][0];
+                D.pred_array[f[1][0]] = current;
+                current = f[1][0];
                 D.routed[current] = true;
                 D.route_num[current] = route_count;
-                if (route_count == 0)
-                {
-                    D.next_array[DARPH_DEPOT] = -current;
-                    D.pred_array[current] = DARPH_DEPOT;
-                }
-                else
-                {
-                    D.next_array[D.route[route_count-1].end] = -current;
-                    D.pred_array[current] = -D.route[route_count-1].end;
-                }
-                // as long as we haven't found the last arc in the dicycle, look for the next arc in the dicycle and
-                // add it to the tour
+            }
+            v = f[1];
+        }
 
-                int passengers_in_vehicle = 0;
-                while (b[1] != G.depot)
-                {
-                    for (const auto& f: cycle_arcs)
-                    {
-                        auto time = B_val[vmap[f[0]]];
-                        if (f[0] == b[1])
-                        {
-                            cycle.push_back(f);
-
-                            if(time < time_passed) {
-                                if(f[0][0] < n)
-                                    passengers_in_vehicle++;
-                                else
-                                    passengers_in_vehicle--;
-                            }
-
-                            vehicle_block << tof->get_printable_event_block(f[0][0], time, time_passed, n);
-                            
-                            if (f[1] != G.depot)
-                            {
-                                D.next_array[current] = f[1][0];
-                                D.pred_array[f[1][0]] = current;
-                                current = f[1][0];
-                                D.routed[current] = true;
-                                D.route_num[current] = route_count;
-                            }
-                    
-                            for (int i = 0; i<2; ++i)
-                            {
-                                for (int j= 0; j<D.veh_capacity; ++j)
-                                {
-                                    b[i][j] = f[i][j];
-                                }
-                            }
-                            cycle_arcs.erase(std::remove(cycle_arcs.begin(), cycle_arcs.end(), f), cycle_arcs.end());
-                            break; 
-                        }
-                    }
-                }
+        std::cout << MANJ_GREEN << "VEHICLE " << route_count+1 << " (CURRENT LOAD: " << passengers_in_vehicle << "/" << D.veh_capacity << ") \n" << FORMAT_STOP;
+        std::cout << vehicle_block.str() << std::endl;
 
-                std::cout << MANJ_GREEN << "VEHICLE " << route_count+1 << " (CURRENT LOAD: " << passengers_in_vehicle << "/" << D.veh_capacity << ") \n" << FORMAT_STOP;
-                std::cout << vehicle_block.str() << std::endl;
+        D.route[route_count].end = current;
+        D.next_array[current] = DARPH_DEPOT;
+        route_count++;
+    }
+    if (route_count > 0)
+        D.pred_array[DARPH_DEPOT] = -D.route[route_count-1].end;
+}
 
-                D.route[route_count].end = current;
-                D.next_array[current] = DARPH_DEPOT;
+template<int Q>
+bool RollingHorizon<Q>::fallback_solve(DARPGraph<Q>& G, IloEnv& env, IloModel& model, IloCplex& cplex, IloIntArray& x_val, IloNumVarArray& x, IloNumVarArray& p, IloRangeArray& accept, double granted)
+{
+    ///
+    /// no solution has been found within the time limit: deny the new requests and
+    /// start from the routes of the last solution which remain feasible without them
+    /// requests accepted by the insertion heuristic or beyond the lookahead horizon are denied only if the promise cannot be kept
+    ///
+    std::stringstream name;
+    IloNumVarArray start_vars(env);
+    IloNumArray start_vals(env);
 
-                for (const auto& a: cycle)
-                {
-                    D.nodes[a[0][0]].beginning_service = B_val[vmap[a[0]]];
-                }
-                cycle.clear();
-                flag = true;
-                route_count++;
+    std::cout << "No solution within " << granted << "s: deny new request(s) and keep last routes" << std::endl;
+    for (const auto& i: new_requests)
+    {
+        if (std::find(promised.begin(), promised.end(), i) != promised.end() || std::find(released.begin(), released.end(), i) != released.end())
+            continue;
+        name << "deny_" << i;
+        accept[rmap[i]] = IloRange(env, 0, p[rmap[i]], 0, name.str().c_str());
+        model.add(accept[rmap[i]]);
+        name.str("");
+        start_vars.add(p[rmap[i]]);
+        start_vals.add(0);
+    }
+    for (const auto& a: G.A)
+    {
+        start_vars.add(x[amap[a]]);
+        start_vals.add(x_val[amap[a]]);
+    }
+    for (const auto& a: G.A_new)
+    {
+        start_vars.add(x[amap[a]]);
+        start_vals.add(0);
+    }
+    cplex.addMIPStart(start_vars, start_vals, IloCplex::MIPStartRepair);
+
+    double time_limit = budget ? budget->draw_reserve(1) : DARPH_MAX(1, notify_requests_sec - granted);
+    set_time_limit(cplex, time_limit);
+    bool solved = cplex.solve();
+
+    if (!solved && (!promised.empty() || !released.empty()))
+    {
+        std::cout << "No solution keeping the promise(s) of the insertion heuristic or of the lookahead: deny promised request(s)" << std::endl;
+        cplex.deleteMIPStarts(0, cplex.getNMIPStarts());
+        for (const auto& i: promised)
+        {
+            accept[rmap[i]].setBounds(0, 0);
+            start_vars.add(p[rmap[i]]);
+            start_vals.add(0);
+        }
+        for (const auto& i: released)
+        {
+            accept[rmap[i]].setBounds(0, 0);
+            start_vars.add(p[rmap[i]]);
+            start_vals.add(0);
+        }
+        cplex.addMIPStart(start_vars, start_vals, IloCplex::MIPStartRepair);
+        time_limit = budget ? budget->draw_reserve(1) : 1;
+        set_time_limit(cplex, time_limit);
+        solved = cplex.solve();
+    }
+
+    cplex.deleteMIPStarts(0, cplex.getNMIPStarts());
+    start_vars.end();
+    start_vals.end();
+    return solved;
+}
+
+template<int Q>
+void RollingHorizon<Q>::keep_last_routes(bool consider_excess_ride_time, DARP& D, DARPGraph<Q>& G, IloNumArray& B_val, IloNumArray& d_val, IloIntArray& p_val, IloIntArray& x_val, IloRangeArray& fixed_B)
+{
+    ///
+    /// neither the MILP nor the fallback has a solution: the routes of the last solution are kept
+    /// and all new requests are denied, promises of the insertion heuristic and commitments
+    /// beyond the lookahead horizon included; arcs and requests of the new requests get value 0
+    ///
+    std::cout << "No solution: keep last routes and deny new request(s)" << std::endl;
+    update_graph_sets(consider_excess_ride_time, G, B_val, d_val, p_val, x_val);
+    traverse_routes(D, G, B_val, x_val, fixed_B);
+    for (const auto& i: new_requests)
+    {
+        if (std::find(promised.begin(), promised.end(), i) != promised.end())
+        {
+            broken_promises += 1;
+            continue;
+        }
+        if (std::find(released.begin(), released.end(), i) != released.end())
+        {
+            broken_commitments += 1;
+            continue;
+        }
+        time_to_answer[i-1] = answer_time(D, i, false);
+        denied_timeout += 1;
+    }
+    kept_routes += 1;
+    total_time_model += dur_model.count();
+    total_time_model_solve += dur_solve.count();
+}
+
+template<int Q>
+bool RollingHorizon<Q>::tabu_start(DARPGraph<Q>& G, IloEnv& env, IloCplex& cplex, IloNumVarArray& x, IloNumVarArray& p)
+{
+    ///
+    /// map the routes of the tabu search to arcs of the event-based graph and add them as MIP start
+    /// an event node consists of the event and the users on board (sorted in descending order)
+    /// returns false if a route cannot be represented by the graph
+    ///
+    std::unordered_map<ARC,bool,HashFunction<Q>> x_start;
+    x_start.reserve(G.A.size() + G.A_new.size());
+    for (const auto& a: G.A)
+        x_start[a] = false;
+    for (const auto& a: G.A_new)
+        x_start[a] = false;
+
+    for (const auto& route: tabu_routes)
+    {
+        std::vector<int> on_board;
+        NODE u = G.depot;
+        for (const auto& k: route)
+        {
+            if (k <= n)
+                on_board.push_back(k);
+            else
+                on_board.erase(std::remove(on_board.begin(), on_board.end(), k-n), on_board.end());
+            std::vector<int> others;
+            for (const auto& j: on_board)
+            {
+                if (j != k)
+                    others.push_back(j);
             }
-            if (flag)
-                break;
+            if (int(others.size()) > Q-1)
+                return false;
+            std::sort(others.begin(), others.end(), std::greater<int>());
+
+            NODE v{};
+            v[0] = k;
+            std::copy(others.begin(), others.end(), v.begin() + 1);
+            auto itr = x_start.find({u, v});
+            if (itr == x_start.end())
+                return false;
+            itr->second = true;
+            u = v;
+        }
+        auto itr = x_start.find({u, G.depot});
+        if (itr == x_start.end())
+            return false;
+        itr->second = true;
+    }
+
+    IloNumVarArray start_vars(env);
+    IloNumArray start_vals(env);
+    for (const auto& e: x_start)
+    {
+        start_vars.add(x[amap[e.first]]);
+        start_vals.add(e.second ? 1 : 0);
+    }
+    for (const auto& i: all_seekers)
+    {
+        start_vars.add(p[rmap[i]]);
+        start_vals.add(1);
+    }
+    for (const auto& i: new_requests)
+    {
+        start_vars.add(p[rmap[i]]);
+        start_vals.add(std::find(tabu_unserved.begin(), tabu_unserved.end(), i) == tabu_unserved.end() ? 1 : 0);
+    }
+    cplex.addMIPStart(start_vars, start_vals, IloCplex::MIPStartRepair);
+    start_vars.end();
+    start_vals.end();
+    return true;
+}
+
+template<int Q>
+void RollingHorizon<Q>::record_solve(IloCplex& cplex, bool solved, double window, double granted, uint64_t model_size)
+{
+    ///
+    /// the budget works in real time like window and granted: in an accelerated simulation the measured times are
+    /// divided by sim_scale, with deterministic limits the solve time follows from the ticks spent and the times
+    /// of the incumbents are unknown
+    ///
+    // incumbent times of the callback are measured from the start of the model update
+    double used = dur_solve.count() - dur_model.count();
+    double first_incumbent = -1;
+    double last_incumbent = -1;
+    if (incumbentCallback && incumbentCallback->get_num_incumbents() > 0)
+    {
+        first_incumbent = incumbentCallback->get_first_incumbent() - dur_model.count();
+        last_incumbent = incumbentCallback->get_last_incumbent() - dur_model.count();
+    }
+    if (simulation && sim_ticks > 0)
+    {
+        used = (cplex.getDetTime() - det_start) / sim_ticks;
+        first_incumbent = -1;
+        last_incumbent = -1;
+    }
+    else if (simulation)
+    {
+        used /= sim_scale;
+        if (first_incumbent >= 0)
+        {
+            first_incumbent /= sim_scale;
+            last_incumbent /= sim_scale;
+        }
+    }
+    budget->record(model_size, window, granted, used, first_incumbent, last_incumbent, solved ? cplex.getMIPRelativeGap() : 1);
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_time_limit(IloCplex& cplex, double phi) const
+{
+    // phi is the real time for the solve; an accelerated simulation scales it or replaces it by deterministic limits
+    if (simulation && sim_ticks > 0)
+    {
+        cplex.setParam(IloCplex::Param::DetTimeLimit, phi * sim_ticks);
+        cplex.setParam(IloCplex::Param::TimeLimit, 1e75);
+    }
+    else
+        cplex.setParam(IloCplex::Param::TimeLimit, simulation ? phi * sim_scale : phi);
+    if (simulation && sim_nodes > 0)
+        cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, sim_nodes);
+}
+
+template<int Q>
+void RollingHorizon<Q>::record_timings(double window, double granted, bool solved)
+{
+    // the iteration is feasible in real time if model update and solve fit into the time between the requests
+    const bool real_time = dur_solve.count() <= window + dur_model.count() + DARPH_EPSILON;
+    if (!real_time)
+        sim_late++;
+    if (timings.is_open())
+        timings << num_milps << "," << time_passed << "," << new_requests.size() << "," << window << "," << granted << "," << dur_model.count() << "," << dur_solve.count() - dur_model.count() << "," << solved << "," << real_time << std::endl;
+}
 
+template<int Q>
+void RollingHorizon<Q>::watch_requests(DARPGraph<Q>& G, IloNumVarArray& B, IloNumVarArray& x, IloNumVarArray& p, const std::vector<int>& requests)
+{
+    // the nodes of the requests of the first MILP are in V_i, those of new requests in V_i_new until update_graph_sets()
+    auto& V_i = (num_milps < 2) ? G.V_i : G.V_i_new;
+    auto& delta_in = (num_milps < 2) ? G.delta_in : G.delta_in_new;
+
+    for (const auto& i: requests)
+    {
+        std::vector<std::pair<IloNumVar, std::vector<IloNumVar>>> pickups;
+        for (const auto& v: V_i[i])
+        {
+            std::vector<IloNumVar> arcs;
+            for (const auto& a: delta_in[v])
+                arcs.push_back(x[amap[a]]);
+            pickups.push_back(std::make_pair(B[vmap[v]], arcs));
         }
+        incumbentCallback->watch(i, p[rmap[i]], pickups);
     }
-    D.pred_array[DARPH_DEPOT] = -D.route[route_count-1].end;
-    cycle_arcs.clear();
+}
+
+template<int Q>
+double RollingHorizon<Q>::answer_time(DARP& D, int i, bool accepted) const
+{
+    // the answer to request i was known as soon as its final answer was contained in an incumbent
+    bool incumbent_accepted;
+    double pickup, answered;
+    if (incumbentCallback && incumbentCallback->answer(i, incumbent_accepted, pickup, answered))
+    {
+        if (incumbent_accepted == accepted && (!accepted || DARPH_ABS(pickup - D.nodes[i].beginning_service) < DARPH_EPSILON))
+            return answered;
+    }
+    return dur_solve.count();
 }
 
 template<int Q>
@@ -3117,13 +3018,27 @@ void RollingHorizon<Q>::get_solution_values(bool consider_excess_ride_time, DARP
     {
         for (const auto& i: new_requests)
         {
+            if (std::find(promised.begin(), promised.end(), i) != promised.end())
+            {
+                // answered by the insertion heuristic already, the communicated pick-up time is kept
+                if (cplex.getValue(p[rmap[i]]) < 0.9)
+                    broken_promises += 1;
+                continue;
+            }
             communicated_pickup[i-1] = D.nodes[i].beginning_service;
 #if VERBOSE
             std::cout << "communicated pick-up request " << i << ": " << communicated_pickup[i-1] << std::endl;
 #endif
+            if (std::find(released.begin(), released.end(), i) != released.end())
+            {
+                // accepted by the reserve check already, only the pick-up time is communicated now
+                if (cplex.getValue(p[rmap[i]]) < 0.9)
+                    broken_commitments += 1;
+                continue;
+            }
         
-            time_to_answer[i-1] = dur_solve.count();
-            if (cplex.getValue(p[rmap[i]]) < 0.9 && time_to_answer[i-1] > notify_requests_sec - 0.001)
+            time_to_answer[i-1] = answer_time(D, i, cplex.getValue(p[rmap[i]]) > 0.9);
+            if (cplex.getValue(p[rmap[i]]) < 0.9 && dur_solve.count() > notify_requests_sec - 0.001)
             {
                 denied_timeout += 1;
             } 
@@ -3142,7 +3057,7 @@ void RollingHorizon<Q>::get_solution_values(bool consider_excess_ride_time, DARP
 #endif
             }
                 
-            time_to_answer[i-1] = dur_solve.count();
+            time_to_answer[i-1] = answer_time(D, i, p_val[rmap[i]] > 0.9);
         }  
     }
     
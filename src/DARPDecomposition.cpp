@@ -0,0 +1,329 @@
+#include "DARPH.h"
+#include "RollingHorizon.h"
+
+template<int Q>
+double RollingHorizon<Q>::earliest_pickup(const DARP& D, int i) const
+{
+    // earliest possible pick-up of request i with respect to both time windows
+    return DARPH_MAX(D.nodes[i].start_tw, D.nodes[n+i].start_tw - D.tt[i][n+i] - D.nodes[i].service_time);
+}
+
+template<int Q>
+void RollingHorizon<Q>::partition_requests(DARP& D, std::vector<std::vector<int>>& slices, std::vector<std::vector<int>>& core) const
+{
+    ///
+    /// core[s] contains the requests whose earliest pick-up lies in time slice s,
+    /// slices[s] additionally the requests up to slice_overlap minutes before or after the slice
+    ///
+    double first = DARPH_INFINITY;
+    double last = -DARPH_INFINITY;
+    for (const auto& i: D.R)
+    {
+        first = DARPH_MIN(first, earliest_pickup(D, i));
+        last = DARPH_MAX(last, earliest_pickup(D, i));
+    }
+    const int num_slices = DARPH_MAX(1, int(std::ceil((last - first + DARPH_EPSILON) / slice_length)));
+
+    slices.assign(num_slices, std::vector<int>());
+    core.assign(num_slices, std::vector<int>());
+    for (const auto& i: D.R)
+    {
+        const double e = earliest_pickup(D, i);
+        core[DARPH_MIN(num_slices - 1, int((e - first) / slice_length))].push_back(i);
+        for (int s = 0; s < num_slices; ++s)
+        {
+            if (e >= first + s * slice_length - slice_overlap && e < first + (s+1) * slice_length + slice_overlap)
+                slices[s].push_back(i);
+        }
+    }
+
+    // nothing to decide in slices without requests of their own
+    for (int s = num_slices - 1; s >= 0; --s)
+    {
+        if (core[s].empty())
+        {
+            slices.erase(slices.begin() + s);
+            core.erase(core.begin() + s);
+        }
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::solve_slice(bool accept_all, bool consider_excess_ride_time, bool heuristic, const DARP& D, const std::vector<int>& requests, int vehicles, std::vector<std::vector<int>>& routes, const std::array<double,3>& w) const
+{
+    ///
+    /// static MILP of the requests of one slice (or cluster) with the given number of vehicles
+    /// in its own instance, graph and CPLEX environment, the routes are returned with the events of D
+    ///
+    routes.clear();
+    if (requests.empty())
+        return;
+    const int m = requests.size();
+    DARP S(m);
+    S.extract(D, requests, vehicles);
+    S.next_array[DARPH_DEPOT] = DARPH_DEPOT; // no routes if CPLEX fails
+    RollingHorizon<Q> RH(m, 0, 0);
+    RH.static_time = static_time;
+    DARPGraph<Q> G(m);
+    RH.solve(accept_all, consider_excess_ride_time, false, heuristic, S, G, w);
+
+    std::vector<std::vector<int>> sub_routes;
+    RH.collect_routes(S, sub_routes);
+    for (const auto& sub_route: sub_routes)
+    {
+        std::vector<int> route;
+        for (const auto& k: sub_route)
+            route.push_back((k <= m) ? requests[k-1] : n + requests[k-m-1]);
+        routes.push_back(route);
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::solve_slices(bool accept_all, bool consider_excess_ride_time, bool heuristic, const DARP& D, const std::vector<std::vector<int>>& slices, const std::vector<int>& vehicles, const std::vector<bool>& todo, std::vector<std::vector<std::vector<int>>>& routes, const std::array<double,3>& w) const
+{
+    // solve the slices marked in todo, slice_threads at a time; the sub-solvers print their own solutions, silence them while they run
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    std::atomic<int> next_slice(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < DARPH_MIN(DARPH_MAX(1, slice_threads), int(slices.size())); ++t)
+    {
+        workers.push_back(std::thread([&]() {
+            for (int s = next_slice++; s < int(slices.size()); s = next_slice++)
+            {
+                if (todo[s])
+                    solve_slice(accept_all, consider_excess_ride_time, heuristic, D, slices[s], vehicles[s], routes[s], w);
+            }
+        }));
+    }
+    for (auto& worker: workers)
+        worker.join();
+    std::cout.rdbuf(out);
+    std::cout.clear();
+}
+
+template<int Q>
+bool RollingHorizon<Q>::check_route(DARP& D, const std::vector<int>& route, bool keep)
+{
+    ///
+    /// evaluate a complete route with the 8-step scheme: time windows, route duration,
+    /// capacity, number of users on board and ride times; the schedule is kept only if keep is true
+    ///
+    std::vector<DARPNode> saved_nodes;
+    std::vector<std::array<int,2>> saved_links;
+    std::vector<int> touched(route);
+    touched.push_back(DARPH_DEPOT);
+    for (const auto& k: touched)
+    {
+        saved_nodes.push_back(D.nodes[k]);
+        saved_links.push_back({D.next_array[k], D.pred_array[k]});
+    }
+
+    DARPRoute path;
+    D.nodes[DARPH_DEPOT].beginning_service = D.nodes[DARPH_DEPOT].start_tw;
+    D.next_array[DARPH_DEPOT] = route.front();
+    D.pred_array[route.front()] = DARPH_DEPOT;
+    for (unsigned int k = 0; k+1 < route.size(); ++k)
+    {
+        D.next_array[route[k]] = route[k+1];
+        D.pred_array[route[k+1]] = route[k];
+    }
+    D.next_array[route.back()] = -1; // mark the end of the path
+    path.start = route.front();
+    path.end = route.back();
+    path.departure_depot = D.nodes[DARPH_DEPOT].start_tw;
+
+    bool feasible = eight_step(D, path, DARPH_DEPOT);
+    if (feasible)
+    {
+        path.departure_depot = D.nodes[route.front()].beginning_service - D.tt[DARPH_DEPOT][route.front()];
+        if (path.return_depot > D.nodes[DARPH_DEPOT].end_tw + DARPH_EPSILON || path.return_depot - path.departure_depot > D.max_route_duration + DARPH_EPSILON)
+            feasible = false;
+    }
+
+    int load = 0;
+    int on_board = 0;
+    for (const auto& k: route)
+    {
+        if (!feasible)
+            break;
+        load += D.nodes[k].demand;
+        on_board += (k <= n) ? 1 : -1;
+        if (load > D.veh_capacity || on_board > Q)
+            feasible = false;
+        if (k > n && D.nodes[k].beginning_service - D.nodes[k-n].beginning_service - D.nodes[k-n].service_time > D.nodes[k].max_ride_time + DARPH_EPSILON)
+            feasible = false;
+    }
+
+    for (unsigned int k = 0; k < touched.size(); ++k)
+    {
+        if (!(keep && feasible) || touched[k] == DARPH_DEPOT)
+            D.nodes[touched[k]] = saved_nodes[k];
+        D.next_array[touched[k]] = saved_links[k][0];
+        D.pred_array[touched[k]] = saved_links[k][1];
+    }
+    return feasible;
+}
+
+template<int Q>
+bool RollingHorizon<Q>::stitch_route(DARP& D, std::vector<std::vector<int>>& vehicles, const std::vector<int>& route)
+{
+    ///
+    /// append the route of a slice to the vehicle that saves most distance and whose boundary state
+    /// (last event and departure there) still reaches the first event in time, otherwise use an unused vehicle
+    ///
+    double best_cost = DARPH_INFINITY;
+    int best = -1;
+    for (unsigned int v = 0; v < vehicles.size(); ++v)
+    {
+        const int last = vehicles[v].back();
+        if (D.nodes[last].departure_time + D.tt[last][route.front()] > D.nodes[route.front()].end_tw + DARPH_EPSILON)
+            continue;
+        const double cost = D.d[last][route.front()] - D.d[last][DARPH_DEPOT] - D.d[DARPH_DEPOT][route.front()];
+        if (cost < best_cost)
+        {
+            std::vector<int> joined(vehicles[v]);
+            joined.insert(joined.end(), route.begin(), route.end());
+            if (check_route(D, joined, false))
+            {
+                best_cost = cost;
+                best = v;
+            }
+        }
+    }
+
+    if (best >= 0)
+    {
+        vehicles[best].insert(vehicles[best].end(), route.begin(), route.end());
+        return check_route(D, vehicles[best], true);
+    }
+    if (int(vehicles.size()) < D.num_vehicles && check_route(D, route, true))
+    {
+        vehicles.push_back(route);
+        return true;
+    }
+    return false;
+}
+
+template<int Q>
+int RollingHorizon<Q>::complete_routes(bool accept_all, bool consider_excess_ride_time, DARP& D, const std::vector<std::vector<int>>& vehicles, const std::vector<int>& unplaced, const std::array<double,3>& w)
+{
+    ///
+    /// link the routes of the sub-problems, insert the requests they did not serve by cheapest insertion
+    /// and evaluate the solution as solve() does; returns the number of inserted requests
+    ///
+    link_routes(D, vehicles);
+    for (const auto& i: D.R)
+        communicated_pickup[i-1] = DARPH_INFINITY;
+    int repaired = 0;
+    for (const auto& i: unplaced)
+    {
+        if (insert_request(D, i, w))
+            repaired++;
+        else
+            all_denied.push_back(i);
+    }
+    if (accept_all && !all_denied.empty())
+        std::cerr << "Decomposition: " << all_denied.size() << " request(s) could not be served." << std::endl;
+
+    std::vector<std::vector<int>> routes;
+    collect_routes(D, routes);
+    total_routing_costs = 0;
+    total_excess_ride_time = 0;
+    for (const auto& route: routes)
+    {
+        int pred = DARPH_DEPOT;
+        int load = 0;
+        for (const auto& k: route)
+        {
+            total_routing_costs += D.d[pred][k];
+            load += D.nodes[k].demand;
+            D.nodes[k].vehicle_load = load;
+            pred = k;
+        }
+        total_routing_costs += D.d[pred][DARPH_DEPOT];
+    }
+    for (const auto& i: D.R)
+    {
+        if (!D.routed[i])
+            continue;
+        communicated_pickup[i-1] = D.nodes[i].beginning_service;
+        if (consider_excess_ride_time)
+            total_excess_ride_time += D.nodes[n+i].beginning_service - D.nodes[i].beginning_service - D.nodes[i].service_time - D.tt[i][n+i];
+    }
+    answered_requests = n - all_denied.size();
+
+    std::cout << MANJ_GREEN << "Total routing costs: " << FORMAT_STOP << total_routing_costs << std::endl;
+    if (consider_excess_ride_time)
+        std::cout << MANJ_GREEN << "Total excess ride time: " << FORMAT_STOP << total_excess_ride_time << std::endl;
+    std::cout << MANJ_GREEN << "Number denied requests: " << FORMAT_STOP << n - answered_requests << std::endl;
+    return repaired;
+}
+
+template<int Q>
+std::array<double,3> RollingHorizon<Q>::decompose(bool accept_all, bool consider_excess_ride_time, bool heuristic, DARP& D, const std::array<double,3>& w)
+{
+    ///
+    /// time-window decomposition for static instances too large for one MILP: requests far apart in time hardly interact,
+    /// so the instance is cut into time slices by earliest pick-up and each slice (with the requests overlapping it)
+    /// is solved as a MILP of its own, in parallel and each in its own CPLEX environment;
+    /// the routes of the slices are then stitched in chronological order, every vehicle passing its boundary state
+    /// on to the next slice, and requests that could not be stitched are inserted by cheapest insertion
+    ///
+    const auto before = clock::now();
+    time_passed = 0;
+    all_denied.clear();
+
+    std::vector<std::vector<int>> slices, core;
+    partition_requests(D, slices, core);
+    std::vector<std::vector<std::vector<int>>> slice_routes(slices.size());
+    solve_slices(accept_all, consider_excess_ride_time, heuristic, D, slices, std::vector<int>(slices.size(), D.num_vehicles), std::vector<bool>(slices.size(), true), slice_routes, w);
+    const sec dur_slices = clock::now() - before;
+
+    // a request is served in the slice whose core contains it
+    std::vector<int> slice_of(n+1, -1);
+    for (unsigned int s = 0; s < core.size(); ++s)
+    {
+        for (const auto& i: core[s])
+            slice_of[i] = s;
+    }
+
+    std::vector<std::vector<int>> vehicles;
+    std::vector<int> unplaced;
+    for (unsigned int s = 0; s < slices.size(); ++s)
+    {
+        std::vector<bool> placed(n+1, false);
+        std::vector<std::vector<int>> routes;
+        for (auto route: slice_routes[s])
+        {
+            route.erase(std::remove_if(route.begin(), route.end(), [&](int k) {return slice_of[(k <= n) ? k : k-n] != int(s);}), route.end());
+            if (!route.empty())
+                routes.push_back(route);
+        }
+        std::sort(routes.begin(), routes.end(), [&](const std::vector<int>& a, const std::vector<int>& b) {return earliest_pickup(D, a.front()) < earliest_pickup(D, b.front());});
+
+        for (const auto& route: routes)
+        {
+            if (!stitch_route(D, vehicles, route))
+                continue;
+            for (const auto& k: route)
+            {
+                if (k <= n)
+                    placed[k] = true;
+            }
+        }
+        for (const auto& i: core[s])
+        {
+            if (!placed[i])
+                unplaced.push_back(i);
+        }
+    }
+    const int repaired = complete_routes(accept_all, consider_excess_ride_time, D, vehicles, unplaced, w);
+    dur_solve = clock::now() - before;
+    std::cout << MANJ_GREEN << "Decomposition: " << FORMAT_STOP << slices.size() << " slices of " << slice_length << " min solved in " << dur_slices.count() << "s, " << repaired << " request(s) inserted when stitching, total " << dur_solve.count() << "s" << std::endl;
+
+    std::array<double,3> obj_value = {total_routing_costs, n - answered_requests, total_excess_ride_time};
+    return obj_value;
+}
+
+template class RollingHorizon<3>;
+template class RollingHorizon<6>;
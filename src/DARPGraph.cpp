@@ -460,6 +460,8 @@ void DARPGraph<Q>::create_new_nodes(DARP& D, int*** f, const std::vector<int> &n
 template <>
 void DARPGraph<3>::create_arcs(DARP& D, int*** f)
 {
+    // the arcs leaving an event read the row of its location
+    DistanceProvider::RowBuffer d_row(D.d), tt_row(D.tt);
     NODE u, w;
     ARC a;
     
@@ -546,8 +548,8 @@ void DARPGraph<3>::create_arcs(DARP& D, int*** f)
                             w = {i, v[1], v[0]};
                         a = {v,w};
                         A.push_back(a);
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -561,7 +563,7 @@ void DARPGraph<3>::create_arcs(DARP& D, int*** f)
             if ((i != (v[0]-n)) && (i != v[1]) && (i != v[2]))
             {
                 // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
                 {
                     // check if nodes (i,...,v[1],...) and (i,...,v[2],...) exist
                     if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]))
@@ -571,8 +573,8 @@ void DARPGraph<3>::create_arcs(DARP& D, int*** f)
                             w = {i, v[1], v[2]};
                             a = {v,w};
                             A.push_back(a);
-                            c[a] = D.d[v[0]][i];
-                            t[a] = D.tt[v[0]][i];
+                            c[a] = d_row(v[0])[i];
+                            t[a] = tt_row(v[0])[i];
                         }
                     }
                 } 
@@ -623,6 +625,8 @@ void DARPGraph<3>::create_arcs(DARP& D, int*** f)
 template <>
 void DARPGraph<6>::create_arcs(DARP& D, int*** f)
 {
+    // the arcs leaving an event read the row of its location
+    DistanceProvider::RowBuffer d_row(D.d), tt_row(D.tt);
     NODE u, w;
     ARC a;
     
@@ -791,8 +795,8 @@ void DARPGraph<6>::create_arcs(DARP& D, int*** f)
                             w = {i, v[1], v[2], v[3], v[4], v[0]};
                         a = {v,w};
                         A.push_back(a);
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -806,7 +810,7 @@ void DARPGraph<6>::create_arcs(DARP& D, int*** f)
             if ((i != (v[0]-n)) && (i != v[1]) && (i != v[2]) && (i != v[3]) && (i != v[4]) && (i != v[5]))
             {
                 // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
                 {
                     // check if nodes (i,...,v[1],...), (i,...,v[2],...), (i,...,v[3],...), (i,...,v[4],...) and (i,...,v[5],...) exist
                     if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]) && (f[i][v[3]][0] || f[i][v[3]][1]) && (f[i][v[4]][0] || f[i][v[4]][1]) && (f[i][v[5]][0] || f[i][v[5]][1]))
@@ -816,8 +820,8 @@ void DARPGraph<6>::create_arcs(DARP& D, int*** f)
                             w = {i, v[1], v[2], v[3], v[4], v[5]};
                             a = {v,w};
                             A.push_back(a);
-                            c[a] = D.d[v[0]][i];
-                            t[a] = D.tt[v[0]][i];
+                            c[a] = d_row(v[0])[i];
+                            t[a] = tt_row(v[0])[i];
                         }
                     }
                 }
@@ -909,6 +913,8 @@ void DARPGraph<6>::create_arcs(DARP& D, int*** f)
 template <>
 void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& new_requests, const std::vector<int>& all_seekers)
 {
+    // the arcs leaving an event read the row of its location
+    DistanceProvider::RowBuffer d_row(D.d), tt_row(D.tt);
     NODE u,w;
     ARC a;
 
@@ -1006,8 +1012,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1026,8 +1032,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1055,8 +1061,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1073,7 +1079,7 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
             if ((i != (v[0]-n)) && (i != v[1]) && (i != v[2]))
             {
                 // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
                 {
                     // check if nodes (i,...,v[1],...) and (i,...,v[2],...) exist
                     if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]))
@@ -1084,8 +1090,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
                             a = {v,w};
                             A_new.push_back(a);
                             num_new_arcs++;
-                            c[a] = D.d[v[0]][i];
-                            t[a] = D.tt[v[0]][i];
+                            c[a] = d_row(v[0])[i];
+                            t[a] = tt_row(v[0])[i];
                         }
                     }
                 }
@@ -1096,7 +1102,7 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
             if ((i != (v[0]-n)) && (i != v[1]) && (i != v[2]))
             {
                 // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
                 {
                     // check if nodes (i,...,v[1],...) and (i,...,v[2],...) exist
                     if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]))
@@ -1107,8 +1113,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
                             a = {v,w};
                             A_new.push_back(a);
                             num_new_arcs++;
-                            c[a] = D.d[v[0]][i];
-                            t[a] = D.tt[v[0]][i];
+                            c[a] = d_row(v[0])[i];
+                            t[a] = tt_row(v[0])[i];
                         }
                     }
                 }
@@ -1158,7 +1164,7 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
         for (const auto & i : new_requests)
         {
             // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-            if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+            if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
             {
                 // check if nodes (i,...,v[1],...) and (i,...,v[2],...) exist
                 if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]))
@@ -1169,8 +1175,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1190,6 +1196,8 @@ void DARPGraph<3>::create_new_arcs(DARP& D, int*** f, const std::vector<int>& ne
 template <>
 void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &new_requests,  const std::vector<int>& all_seekers)
 {
+    // the arcs leaving an event read the row of its location
+    DistanceProvider::RowBuffer d_row(D.d), tt_row(D.tt);
     NODE u,w;
     ARC a;
 
@@ -1372,8 +1380,8 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1398,8 +1406,8 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1433,8 +1441,8 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1451,7 +1459,7 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
             if ((i != (v[0]-n)) && (i != v[1]) && (i != v[2]) && (i != v[3]) && (i != v[4]) && (i != v[5]))
             {
                 // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
                 {
                     // check if nodes (i,...,v[1],...), (i,...,v[2],...), (i,...,v[3],...), (i,...,v[4],...) and (i,...,v[5],...) exist
                     if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]) && (f[i][v[3]][0] || f[i][v[3]][1]) && (f[i][v[4]][0] || f[i][v[4]][1]) && (f[i][v[5]][0] || f[i][v[5]][1]))
@@ -1462,8 +1470,8 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
                             a = {v,w};
                             A_new.push_back(a);
                             num_new_arcs++;
-                            c[a] = D.d[v[0]][i];
-                            t[a] = D.tt[v[0]][i];
+                            c[a] = d_row(v[0])[i];
+                            t[a] = tt_row(v[0])[i];
                         }
                     }
                 }
@@ -1474,7 +1482,7 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
             if ((i != (v[0]-n)) && (i != v[1]) && (i != v[2]) && (i != v[3]) && (i != v[4]) && (i != v[5]))
             {
                 // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+                if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
                 {
                     // check if nodes (i,...,v[1],...), (i,...,v[2],...), (i,...,v[3],...), (i,...,v[4],...) and (i,...,v[5],...) exist
                     if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]) && (f[i][v[3]][0] || f[i][v[3]][1]) && (f[i][v[4]][0] || f[i][v[4]][1]) && (f[i][v[5]][0] || f[i][v[5]][1]))
@@ -1485,8 +1493,8 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
                             a = {v,w};
                             A_new.push_back(a);
                             num_new_arcs++;
-                            c[a] = D.d[v[0]][i];
-                            t[a] = D.tt[v[0]][i];
+                            c[a] = d_row(v[0])[i];
+                            t[a] = tt_row(v[0])[i];
                         }
                     }
                 }
@@ -1577,7 +1585,7 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
         for (const auto & i : new_requests)
         {
             // check if pick-up after drop-off is feasible e_{n+j} + s_j + t_{n+j,i} < l_i
-            if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + D.tt[v[0]][i] <= D.nodes[i].end_tw)
+            if (D.nodes[v[0]].start_tw + D.nodes[v[0]].service_time + tt_row(v[0])[i] <= D.nodes[i].end_tw)
             {
                 // check if nodes (i,...,v[1],...), (i,...,v[2],...), (i,...,v[3],...), (i,...,v[4],...) and (i,...,v[5],...) exist
                 if ((f[i][v[1]][0] || f[i][v[1]][1]) && (f[i][v[2]][0] || f[i][v[2]][1]) && (f[i][v[3]][0] || f[i][v[3]][1]) && (f[i][v[4]][0] || f[i][v[4]][1]) && (f[i][v[5]][0] || f[i][v[5]][1]))
@@ -1588,8 +1596,8 @@ void DARPGraph<6>::create_new_arcs(DARP& D, int*** f, const std::vector<int> &ne
                         a = {v,w};
                         A_new.push_back(a);
                         num_new_arcs++;
-                        c[a] = D.d[v[0]][i];
-                        t[a] = D.tt[v[0]][i];
+                        c[a] = d_row(v[0])[i];
+                        t[a] = tt_row(v[0])[i];
                     }
                 }
             }
@@ -1,31 +1,237 @@
 #include "DARPH.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename, bool copy_on_write)
+{
+    ///
+    /// map filename into memory, is_open() is false if that fails;
+    /// an empty file is open with an empty range
+    ///
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info;
+    if (fstat(fd, &info) == 0)
+    {
+        size = info.st_size;
+        if (size == 0)
+            opened = true;
+        else
+        {
+            void* map = mmap(nullptr, size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+                // text is read front to back, a compiled instance is needed as a whole
+                madvise(map, size, copy_on_write ? MADV_WILLNEED : MADV_SEQUENTIAL);
+                data = static_cast<char*>(map);
+                opened = true;
+            }
+            else
+                size = 0;
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data)
+        munmap(data, size);
+}
 
 int DARPGetDimension(std::string filename)
 {
-    /// 
+    ///
     /// Open up filename and scan for the number of nodes
     ///
-    std::ifstream file;
-    std::string line;
-    int dimension;
-    
-    file.open(filename.c_str(),std::ios_base::in);
-    if (!file)
+    MappedFile file(filename);
+    if (!file.is_open())
     {
-        fprintf(stderr, "Unable to open %s for reading\n", filename);
+        fprintf(stderr, "Unable to open %s for reading\n", filename.c_str());
         exit(-1);
     }
-    
-    getline(file,line);
-    std::istringstream f(line);
-    f >> dimension; // first number is number of vehicles not dimemsion
-    f >> dimension; // second number is dimension
+
+    const DARPBinaryHeader* header = reinterpret_cast<const DARPBinaryHeader*>(file.begin());
+    if (file.end() - file.begin() >= long(sizeof(DARPBinaryHeader)) && header->magic == DARPBinaryHeader::magic_number)
+        return header->num_nodes;
+
+    const char* p = file.begin();
+    int dimension = 0;
+    parse_next(p, file.end(), dimension); // first number is number of vehicles not dimemsion
+    parse_next(p, file.end(), dimension); // second number is dimension
 #if FILE_DEBUG
-    printf("Number of nodes 2n = %d\n", dimension); 
+    printf("Number of nodes 2n = %d\n", dimension);
 #endif
 
-    file.close();
     return dimension;
 }
 
+// size and modification time of a file, (0, 0) if it does not exist
+static std::pair<uint64_t,int64_t> DARPFileStamp(const std::string& filename)
+{
+    struct stat info;
+    if (filename.empty() || stat(filename.c_str(), &info) != 0)
+        return std::make_pair(0, 0);
+    return std::make_pair(uint64_t(info.st_size), int64_t(info.st_mtime));
+}
+
+std::string DARPCostsPath(const std::string& data_directory, const std::string& instance)
+{
+    return data_directory + instance + "_c_a.txt";
+}
+
+std::string DARPInstancePath(const std::string& data_directory, const std::string& instance)
+{
+    ///
+    /// an instance compiled by darp_compile is preferred to the text files
+    /// unless they have changed since it was compiled (size or modification time)
+    ///
+    const std::string compiled = data_directory + instance + ".darp";
+    const std::string text = data_directory + instance + ".txt";
+    DARPBinaryHeader header = {};
+    std::ifstream in(compiled, std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != DARPBinaryHeader::magic_number)
+        return text;
+    if (header.version != DARPBinaryHeader::current_version)
+    {
+        std::cerr << compiled << " has version " << header.version << ", reading " << text << " (compile it again)" << std::endl;
+        return text;
+    }
+    // a compiled instance may be shipped without its text files
+    if (access(text.c_str(), R_OK) != 0)
+        return compiled;
+    const auto source = DARPFileStamp(text);
+    const auto costs = DARPFileStamp(header.costs_size > 0 ? DARPCostsPath(data_directory, instance) : "");
+    if (source != std::make_pair(header.source_size, header.source_mtime) || costs != std::make_pair(header.costs_size, header.costs_mtime))
+    {
+        std::cerr << compiled << " is out of date, reading " << text << " (compile it again)" << std::endl;
+        return text;
+    }
+    return compiled;
+}
 
+bool DARP::read_binary(std::string infile)
+{
+    ///
+    /// load an instance compiled by darp_compile without parsing: the file is mapped copy-on-write
+    /// and d and tt point into the mapping; false if infile is no compiled instance
+    ///
+    MappedFile* file = new MappedFile(infile, true);
+    const DARPBinaryHeader* header = reinterpret_cast<const DARPBinaryHeader*>(file->begin());
+    const size_t size = file->end() - file->begin();
+    if (!file->is_open() || size < sizeof(DARPBinaryHeader) || header->magic != DARPBinaryHeader::magic_number)
+    {
+        delete file;
+        return false;
+    }
+    if (header->version != DARPBinaryHeader::current_version)
+        report_error("%s: %s has version %u, expected %u\n", __FUNCTION__, infile.c_str(), header->version, DARPBinaryHeader::current_version);
+    if (header->num_nodes != num_nodes)
+        report_error("%s: %s has %d nodes, expected %d\n", __FUNCTION__, infile.c_str(), header->num_nodes, num_nodes);
+    const size_t matrix = sizeof(double) * (num_nodes + 1) * (num_nodes + 1);
+    const size_t node_bytes = sizeof(DARPBinaryNode) * (num_nodes + 1);
+    if (header->nodes_offset + node_bytes > size || header->d_offset + matrix > size || header->tt_offset + matrix > size)
+        report_error("%s: %s is truncated\n", __FUNCTION__, infile.c_str());
+
+    instance_mode = header->instance_mode;
+    num_vehicles = header->num_vehicles;
+    veh_capacity = header->veh_capacity;
+    max_route_duration = header->max_route_duration;
+    planning_horizon = header->planning_horizon;
+
+    const DARPBinaryNode* records = reinterpret_cast<const DARPBinaryNode*>(file->begin() + header->nodes_offset);
+    for (int i = 0; i <= num_nodes; ++i)
+    {
+        nodes[i].id = records[i].id;
+        nodes[i].demand = records[i].demand;
+        nodes[i].x = records[i].x;
+        nodes[i].y = records[i].y;
+        nodes[i].tw_length = records[i].tw_length;
+        nodes[i].max_ride_time = records[i].max_ride_time;
+        nodes[i].service_time = records[i].service_time;
+        nodes[i].start_tw = records[i].start_tw;
+        nodes[i].end_tw = records[i].end_tw;
+    }
+
+    // d and tt are stored in the mapping from now on, tt only once if it equals d (instance mode 1)
+    d.map(num_nodes + 1, reinterpret_cast<double*>(file->writable_begin() + header->d_offset));
+    if (header->tt_offset == header->d_offset)
+        tt.alias(d);
+    else
+        tt.map(num_nodes + 1, reinterpret_cast<double*>(file->writable_begin() + header->tt_offset));
+    mapped = file;
+
+    route = new DARPRoute[num_vehicles];
+    return true;
+}
+
+void DARP::write_binary(std::string outfile) const
+{
+    ///
+    /// write the instance as read by read_file in the format of DARPBinary.h,
+    /// stamped with the text files it was read from; tt is not stored again if it shares d
+    ///
+    std::ofstream out(outfile, std::ios::binary);
+    if (!out)
+        report_error("%s: cannot open %s\n", __FUNCTION__, outfile.c_str());
+
+    auto align = [](uint64_t offset) {return (offset + 63) / 64 * 64;};
+    const uint64_t matrix = sizeof(double) * (num_nodes + 1) * (num_nodes + 1);
+    DARPBinaryHeader header = {};
+    header.magic = DARPBinaryHeader::magic_number;
+    header.version = DARPBinaryHeader::current_version;
+    header.instance_mode = instance_mode;
+    header.num_vehicles = num_vehicles;
+    header.num_nodes = num_nodes;
+    header.veh_capacity = veh_capacity;
+    header.max_route_duration = max_route_duration;
+    header.planning_horizon = planning_horizon;
+    header.nodes_offset = align(sizeof(DARPBinaryHeader));
+    header.d_offset = align(header.nodes_offset + sizeof(DARPBinaryNode) * (num_nodes + 1));
+    const bool shared = tt.shares(d);
+    header.tt_offset = shared ? header.d_offset : align(header.d_offset + matrix);
+    std::tie(header.source_size, header.source_mtime) = DARPFileStamp(source_file);
+    std::tie(header.costs_size, header.costs_mtime) = DARPFileStamp(costs_file);
+
+    std::vector<DARPBinaryNode> records(num_nodes + 1);
+    for (int i = 0; i <= num_nodes; ++i)
+    {
+        records[i].id = nodes[i].id;
+        records[i].demand = nodes[i].demand;
+        records[i].x = nodes[i].x;
+        records[i].y = nodes[i].y;
+        records[i].tw_length = nodes[i].tw_length;
+        records[i].max_ride_time = nodes[i].max_ride_time;
+        records[i].service_time = nodes[i].service_time;
+        records[i].start_tw = nodes[i].start_tw;
+        records[i].end_tw = nodes[i].end_tw;
+    }
+
+    const std::vector<char> padding(64, 0);
+    auto pad = [&](uint64_t offset) {out.write(padding.data(), offset - out.tellp());};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pad(header.nodes_offset);
+    out.write(reinterpret_cast<const char*>(records.data()), sizeof(DARPBinaryNode) * records.size());
+    // row by row, the matrices may be computed from coordinates
+    std::vector<double> row(num_nodes + 1);
+    pad(header.d_offset);
+    for (int i = 0; i <= num_nodes; ++i)
+    {
+        d.fill_row(i, 0, num_nodes + 1, row.data());
+        out.write(reinterpret_cast<const char*>(row.data()), sizeof(double) * row.size());
+    }
+    if (!shared)
+    {
+        pad(header.tt_offset);
+        for (int i = 0; i <= num_nodes; ++i)
+        {
+            tt.fill_row(i, 0, num_nodes + 1, row.data());
+            out.write(reinterpret_cast<const char*>(row.data()), sizeof(double) * row.size());
+        }
+    }
+    if (!out)
+        report_error("%s: error writing %s\n", __FUNCTION__, outfile.c_str());
+}
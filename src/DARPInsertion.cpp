@@ -0,0 +1,350 @@
+#include "DARPH.h"
+#include "RollingHorizon.h"
+
+template<int Q>
+void RollingHorizon<Q>::collect_routes(DARP& D, std::vector<std::vector<int>>& routes) const
+{
+    ///
+    /// read the routes of the current solution from the next array
+    /// a negative entry marks the start of the next route, DARPH_DEPOT the end of the last route
+    ///
+    routes.clear();
+    int start = -D.next_array[DARPH_DEPOT];
+    while (start > 0)
+    {
+        std::vector<int> route;
+        int current = start;
+        while (current > 0)
+        {
+            route.push_back(current);
+            current = D.next_array[current];
+        }
+        routes.push_back(route);
+        start = -current;
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::link_routes(DARP& D, const std::vector<std::vector<int>>& routes)
+{
+    // same linking of next/pred arrays as in traverse_routes()
+    D.next_array[DARPH_DEPOT] = DARPH_DEPOT;
+    int r = 0;
+    for (const auto& route: routes)
+    {
+        D.route[r].start = route.front();
+        D.route[r].end = route.back();
+        D.route[r].has_customers = true;
+        if (r == 0)
+        {
+            D.next_array[DARPH_DEPOT] = -route.front();
+            D.pred_array[route.front()] = DARPH_DEPOT;
+        }
+        else
+        {
+            D.next_array[D.route[r-1].end] = -route.front();
+            D.pred_array[route.front()] = -D.route[r-1].end;
+        }
+        for (unsigned int k = 0; k < route.size(); ++k)
+        {
+            D.routed[route[k]] = true;
+            D.route_num[route[k]] = r;
+            if (k+1 < route.size())
+            {
+                D.next_array[route[k]] = route[k+1];
+                D.pred_array[route[k+1]] = route[k];
+            }
+        }
+        D.next_array[route.back()] = DARPH_DEPOT;
+        r++;
+    }
+    if (r > 0)
+        D.pred_array[DARPH_DEPOT] = -D.route[r-1].end;
+}
+
+template<int Q>
+int RollingHorizon<Q>::first_open(DARP& D, const std::vector<int>& route) const
+{
+    // the vehicle has left for every event up to the last one whose arc would be fixed by query_solution(),
+    // new events can only be inserted after it
+    int open = 0;
+    int pred = DARPH_DEPOT;
+    for (unsigned int k = 0; k < route.size(); ++k)
+    {
+        if (time_passed >= D.nodes[route[k]].beginning_service - D.tt[pred][route[k]])
+            open = k+1;
+        pred = route[k];
+    }
+    return open;
+}
+
+template<int Q>
+bool RollingHorizon<Q>::evaluate_insertion(DARP& D, const std::vector<int>& route, int open, int i, int pickup_gap, int dropoff_gap, double& cost, const std::array<double,3>& w, bool keep)
+{
+    ///
+    /// insert pick-up i before route[pickup_gap] and drop-off n+i before route[dropoff_gap] (at the end of the route if the gap equals its size)
+    /// and evaluate the open part of the route with the 8-step scheme going in from the last event the vehicle has left for
+    /// the schedule is kept only if keep is true, next/pred arrays are always restored
+    ///
+    DARPRoute path;
+    std::vector<int> tail;
+    for (int g = open; g <= int(route.size()); ++g)
+    {
+        if (g == pickup_gap)
+            tail.push_back(i);
+        if (g == dropoff_gap)
+            tail.push_back(n+i);
+        if (g < int(route.size()))
+            tail.push_back(route[g]);
+    }
+    const int anchor = (open > 0) ? route[open-1] : DARPH_DEPOT;
+
+    // save everything the evaluation overwrites
+    std::vector<int> touched(route);
+    touched.push_back(i);
+    touched.push_back(n+i);
+    touched.push_back(DARPH_DEPOT);
+    std::vector<DARPNode> saved_nodes;
+    std::vector<std::array<int,2>> saved_links;
+    for (const auto& k: touched)
+    {
+        saved_nodes.push_back(D.nodes[k]);
+        saved_links.push_back({D.next_array[k], D.pred_array[k]});
+    }
+
+    // ride times of users on board are measured from the departure at their pick-up
+    for (int k = 0; k < open; ++k)
+        D.nodes[route[k]].departure_time = D.nodes[route[k]].beginning_service + D.nodes[route[k]].service_time;
+    if (anchor == DARPH_DEPOT)
+        D.nodes[DARPH_DEPOT].beginning_service = D.nodes[DARPH_DEPOT].start_tw;
+
+    D.next_array[anchor] = tail.front();
+    D.pred_array[tail.front()] = anchor;
+    for (unsigned int k = 0; k+1 < tail.size(); ++k)
+    {
+        D.next_array[tail[k]] = tail[k+1];
+        D.pred_array[tail[k+1]] = tail[k];
+    }
+    D.next_array[tail.back()] = -1; // mark the end of the path
+    path.start = tail.front();
+    path.end = tail.back();
+    if (open > 0)
+        path.departure_depot = D.nodes[route.front()].beginning_service - D.tt[DARPH_DEPOT][route.front()];
+    else
+        path.departure_depot = DARPH_MAX(D.nodes[DARPH_DEPOT].start_tw, time_passed);
+
+    bool feasible = eight_step(D, path, anchor, time_passed);
+
+    if (feasible)
+    {
+        if (open == 0)
+            path.departure_depot = D.nodes[tail.front()].beginning_service - D.tt[DARPH_DEPOT][tail.front()];
+        if (path.return_depot > D.nodes[DARPH_DEPOT].end_tw + DARPH_EPSILON || path.return_depot - path.departure_depot > D.max_route_duration + DARPH_EPSILON)
+            feasible = false;
+    }
+
+    if (feasible)
+    {
+        // load and number of users on board at the anchor, the event-based graph only knows Q users on board
+        int load = 0;
+        int on_board = 0;
+        for (int k = 0; k < open; ++k)
+        {
+            load += D.nodes[route[k]].demand;
+            on_board += (route[k] <= n) ? 1 : -1;
+        }
+        for (const auto& k: tail)
+        {
+            load += D.nodes[k].demand;
+            on_board += (k <= n) ? 1 : -1;
+            if (load > D.veh_capacity || on_board > Q)
+            {
+                feasible = false;
+                break;
+            }
+            if (k > n && D.nodes[k].beginning_service - D.nodes[k-n].beginning_service - D.nodes[k-n].service_time > D.nodes[k].max_ride_time + DARPH_EPSILON)
+            {
+                feasible = false;
+                break;
+            }
+            // pick-up times communicated to accepted users may be delayed by pickup_delay_param minutes at most
+            if (k <= n && k != i && D.nodes[k].beginning_service > communicated_pickup[k-1] + pickup_delay_param + DARPH_EPSILON)
+            {
+                feasible = false;
+                break;
+            }
+        }
+    }
+
+    if (feasible)
+    {
+        // additional routing costs and excess ride time of request i
+        double len = 0;
+        double len_old = 0;
+        int pred = anchor;
+        for (const auto& k: tail)
+        {
+            len += D.d[pred][k];
+            pred = k;
+        }
+        len += D.d[pred][DARPH_DEPOT];
+        pred = anchor;
+        for (int g = open; g < int(route.size()); ++g)
+        {
+            len_old += D.d[pred][route[g]];
+            pred = route[g];
+        }
+        if (open < int(route.size()) || anchor != DARPH_DEPOT)
+            len_old += D.d[pred][DARPH_DEPOT];
+        cost = w[0] * (len - len_old) + w[2] * (D.nodes[n+i].beginning_service - D.nodes[i].beginning_service - D.nodes[i].service_time - D.tt[i][n+i]);
+    }
+
+    for (unsigned int k = 0; k < touched.size(); ++k)
+    {
+        if (!(keep && feasible) || touched[k] == DARPH_DEPOT)
+            D.nodes[touched[k]] = saved_nodes[k];
+        D.next_array[touched[k]] = saved_links[k][0];
+        D.pred_array[touched[k]] = saved_links[k][1];
+    }
+    return feasible;
+}
+
+template<int Q>
+bool RollingHorizon<Q>::insert_request(DARP& D, int i, const std::array<double,3>& w)
+{
+    ///
+    /// cheapest feasible insertion of request i into the current routes or into an unused vehicle
+    ///
+    std::vector<std::vector<int>> routes;
+    collect_routes(D, routes);
+    // all unused vehicles are alike, try one of them
+    if (int(routes.size()) < D.num_vehicles)
+        routes.push_back(std::vector<int>());
+
+    double cost;
+    double best_cost = DARPH_INFINITY;
+    int best_route = -1;
+    int best_open = 0, best_pickup = 0, best_dropoff = 0;
+
+    for (unsigned int r = 0; r < routes.size(); ++r)
+    {
+        const int open = first_open(D, routes[r]);
+        for (int pickup_gap = open; pickup_gap <= int(routes[r].size()); ++pickup_gap)
+        {
+            for (int dropoff_gap = pickup_gap; dropoff_gap <= int(routes[r].size()); ++dropoff_gap)
+            {
+                if (evaluate_insertion(D, routes[r], open, i, pickup_gap, dropoff_gap, cost, w) && cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_route = r;
+                    best_open = open;
+                    best_pickup = pickup_gap;
+                    best_dropoff = dropoff_gap;
+                }
+            }
+        }
+    }
+    if (best_route < 0)
+        return false;
+
+    // keep the schedule of the best insertion and link the extended route
+    evaluate_insertion(D, routes[best_route], best_open, i, best_pickup, best_dropoff, cost, w, true);
+    std::vector<int>& route = routes[best_route];
+    route.insert(route.begin() + best_dropoff, n+i);
+    route.insert(route.begin() + best_pickup, i);
+    link_routes(D, routes);
+    return true;
+}
+
+template<int Q>
+void RollingHorizon<Q>::answer_by_insertion(DARP& D, const std::array<double,3>& w)
+{
+    ///
+    /// answer new requests as soon as they are revealed: a request that can be inserted into the current routes
+    /// is accepted with the pick-up time of the insertion, the MILP has to keep this promise
+    /// requests that cannot be inserted are answered by the MILP
+    ///
+    const auto before = clock::now();
+    promised.clear();
+
+    for (const auto& i: new_requests)
+    {
+        if (insert_request(D, i, w))
+        {
+            promised.push_back(i);
+            communicated_pickup[i-1] = D.nodes[i].beginning_service;
+            time_to_answer[i-1] = sec(clock::now() - before).count();
+            promised_requests += 1;
+#if VERBOSE
+            std::cout << "communicated pick-up request " << i << " (insertion): " << communicated_pickup[i-1] << std::endl;
+#endif
+        }
+    }
+}
+
+template<int Q>
+TabuSearch RollingHorizon<Q>::prepare_tabu_search(bool accept_all, DARP& D, const std::array<double,3>& w)
+{
+    ///
+    /// copy the current routes into a tabu search, must be called before the next array and
+    /// the schedule in D.nodes are overwritten by checking new paths
+    ///
+    TabuSearch ts(D, Q, time_passed, w);
+    std::vector<std::vector<int>> routes;
+    collect_routes(D, routes);
+    for (const auto& route: routes)
+    {
+        const int open = first_open(D, route);
+        ts.add_route(route, open);
+        // all users in the routes have been accepted with a communicated pick-up time
+        for (unsigned int k = open; k < route.size(); ++k)
+        {
+            if (route[k] <= n)
+                ts.promise(route[k], communicated_pickup[route[k]-1] + pickup_delay_param);
+        }
+    }
+    for (int r = routes.size(); r < D.num_vehicles; ++r)
+        ts.add_route(std::vector<int>(), 0);
+
+    for (const auto& i: new_requests)
+    {
+        if (std::find(promised.begin(), promised.end(), i) == promised.end())
+        {
+            ts.add_unserved(i);
+            if (accept_all)
+                ts.accept(i);
+        }
+    }
+    return ts;
+}
+
+template<int Q>
+void RollingHorizon<Q>::tabu_search(const TabuSearch& start)
+{
+    // independent runs with different seeds and tabu tenures, keep the best feasible solution
+    std::vector<TabuSearch> runs(tabu_threads, start);
+    std::vector<std::thread> workers;
+    for (int k = 0; k < tabu_threads; ++k)
+        workers.push_back(std::thread(&TabuSearch::run, &runs[k], tabu_time, k+1));
+    for (auto& worker: workers)
+        worker.join();
+
+    tabu_found = false;
+    double best_costs = DARPH_INFINITY;
+    for (const auto& ts: runs)
+    {
+        if (ts.get_found() && ts.get_best_costs() < best_costs)
+        {
+            tabu_found = true;
+            best_costs = ts.get_best_costs();
+            ts.get_best_routes(tabu_routes);
+            tabu_unserved = ts.get_best_unserved();
+        }
+#if VERBOSE
+        std::cout << "Tabu search: " << ts.get_iterations() << " iterations, best costs " << ts.get_best_costs() << std::endl;
+#endif
+    }
+}
+
+template class RollingHorizon<3>;
+template class RollingHorizon<6>;
@@ -0,0 +1,181 @@
+#include "DARPH.h"
+#include "RollingHorizon.h"
+
+template<int Q>
+void RollingHorizon<Q>::set_race(int size)
+{
+    race_size = DARPH_MIN(size, num_race_configs);
+    // the clones are read from a file of this run
+    race_file = "race_" + std::to_string(clock::now().time_since_epoch().count()) + ".sav";
+}
+
+template<int Q>
+void RollingHorizon<Q>::race_order(std::vector<int>& order) const
+{
+    // configurations ordered by their share of wins (Laplace estimate), untried configurations come first among equals
+    order.resize(num_race_configs);
+    for (int k = 0; k < num_race_configs; ++k)
+        order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return (race_wins[a] + 1.0) / (race_entries[a] + 2) > (race_wins[b] + 1.0) / (race_entries[b] + 2);
+    });
+}
+
+template<int Q>
+bool RollingHorizon<Q>::race(DARP& D, DARPGraph<Q>& G, IloEnv& env, IloCplex& cplex, IloNumVarArray& x, IloNumVarArray& p, double phi)
+{
+    ///
+    /// race differently configured copies of the MILP within the time limit phi: the model is cloned into
+    /// race_size - 1 environments of their own, every copy runs with another MIP emphasis and seed on its share
+    /// of the threads and the main model takes part with the most successful configuration; a copy that
+    /// finishes before the time limit stops the others, otherwise the best incumbent at the time limit wins
+    /// the incumbent of a winning copy is handed to the main model as MIP start
+    /// cloning the model and the transfer of the incumbent count against phi as well
+    ///
+    const auto start = clock::now();
+    // seconds of phi used so far; deterministic limits of a reproducible simulation do not depend on the clock
+    auto used = [this, &start]() {
+        const sec elapsed = clock::now() - start;
+        if (!simulation)
+            return elapsed.count();
+        return (sim_ticks > 0) ? 0.0 : elapsed.count() / sim_scale;
+    };
+    const double transfer = DARPH_MIN(1.0, 0.1 * phi); // kept back for the transfer of the incumbent
+    const int emphasis = cplex.getParam(IloCplex::Param::Emphasis::MIP);
+    const int seed = cplex.getParam(IloCplex::Param::RandomSeed);
+    const int main_threads = cplex.getParam(IloCplex::Param::Threads);
+    const int threads = DARPH_MAX(1, int(std::thread::hardware_concurrency()) / race_size);
+    std::vector<int> order;
+    race_order(order);
+
+    cplex.exportModel(race_file.c_str());
+    std::vector<Racer> racers(race_size - 1);
+    for (int k = 0; k < race_size - 1; ++k)
+    {
+        Racer& racer = racers[k];
+        racer.config = order[k+1];
+        racer.model = IloModel(racer.env);
+        racer.vars = IloNumVarArray(racer.env);
+        racer.ranges = IloRangeArray(racer.env);
+        racer.cplex = IloCplex(racer.env);
+        racer.cplex.importModel(racer.model, race_file.c_str(), racer.obj, racer.vars, racer.ranges);
+        racer.cplex.extract(racer.model);
+        racer.cplex.setOut(racer.env.getNullStream());
+        racer.cplex.setParam(IloCplex::Param::Simplex::Tolerances::Feasibility, 0.0001);
+        racer.cplex.setParam(IloCplex::Param::Emphasis::MIP, racer.config);
+        racer.cplex.setParam(IloCplex::Param::RandomSeed, sim_seed + racer.config);
+        racer.cplex.setParam(IloCplex::Param::Threads, threads);
+        racer.aborter = IloCplex::Aborter(racer.env);
+        racer.cplex.use(racer.aborter);
+    }
+    std::remove(race_file.c_str());
+
+    // all copies run on what is left of phi after cloning
+    const double limit = DARPH_MAX(0.1, phi - used() - transfer);
+    for (auto& racer: racers)
+        set_time_limit(racer.cplex, limit);
+    set_time_limit(cplex, limit);
+
+    IloCplex::Aborter aborter(env);
+    cplex.use(aborter);
+    cplex.setParam(IloCplex::Param::Emphasis::MIP, order[0]);
+    cplex.setParam(IloCplex::Param::RandomSeed, sim_seed + order[0]);
+    cplex.setParam(IloCplex::Param::Threads, threads);
+
+    // whoever proves optimality (or infeasibility) first stops the others
+    auto stop = [&racers, &aborter]() {
+        aborter.abort();
+        for (auto& racer: racers)
+            racer.aborter.abort();
+    };
+    std::vector<std::thread> workers;
+    for (auto& racer: racers)
+    {
+        workers.push_back(std::thread([&racer, &stop]() {
+            racer.solved = racer.cplex.solve();
+            if (racer.solved)
+                racer.objective = racer.cplex.getObjValue();
+            if (racer.cplex.getStatus() == IloAlgorithm::Optimal || racer.cplex.getStatus() == IloAlgorithm::Infeasible)
+                stop();
+        }));
+    }
+    bool solved = cplex.solve();
+    if (cplex.getStatus() == IloAlgorithm::Optimal || cplex.getStatus() == IloAlgorithm::Infeasible)
+        stop();
+    for (auto& worker: workers)
+        worker.join();
+
+    // the main model wins ties, its solution needs no transfer
+    Racer* winner = nullptr;
+    double objective = solved ? cplex.getObjValue() : DARPH_INFINITY;
+    for (auto& racer: racers)
+    {
+        if (racer.solved && racer.objective < objective - DARPH_EPSILON)
+        {
+            objective = racer.objective;
+            winner = &racer;
+        }
+    }
+    race_entries[order[0]]++;
+    for (const auto& racer: racers)
+        race_entries[racer.config]++;
+    if (solved || winner)
+        race_wins[winner ? winner->config : order[0]]++;
+
+    cplex.remove(aborter);
+    aborter.end();
+    cplex.setParam(IloCplex::Param::Emphasis::MIP, emphasis);
+    cplex.setParam(IloCplex::Param::RandomSeed, seed);
+    cplex.setParam(IloCplex::Param::Threads, main_threads);
+    if (winner)
+    {
+        // load the incumbent of the winner into the main model, CPLEX only has to complete it
+        std::unordered_map<std::string,int> column;
+        for (int k = 0; k < winner->vars.getSize(); ++k)
+            column[winner->vars[k].getName()] = k;
+        IloNumVarArray start_vars(env);
+        IloNumArray start_vals(env);
+        auto add_start = [&](const IloNumVar& var) {
+            const auto it = column.find(var.getName());
+            if (it == column.end())
+                return;
+            start_vars.add(var);
+            start_vals.add((winner->cplex.getValue(winner->vars[it->second]) > 0.9) ? 1 : 0);
+        };
+        for (const auto& a: G.A)
+            add_start(x[amap[a]]);
+        for (const auto& a: G.A_new)
+            add_start(x[amap[a]]);
+        for (const auto& i: D.R)
+            add_start(p[rmap[i]]);
+        cplex.addMIPStart(start_vars, start_vals, IloCplex::MIPStartRepair);
+        cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, 0);
+        set_time_limit(cplex, DARPH_MAX(0.1, phi - used()));
+        solved = cplex.solve();
+        cplex.setParam(IloCplex::Param::MIP::Limits::Nodes, 9223372036800000000);
+        cplex.deleteMIPStarts(0, cplex.getNMIPStarts());
+        start_vars.end();
+        start_vals.end();
+    }
+#if VERBOSE
+    std::cout << "Race won by " << race_names[winner ? winner->config : order[0]] << ", objective " << objective << std::endl;
+#endif
+
+    for (auto& racer: racers)
+    {
+        racer.aborter.end();
+        racer.env.end();
+    }
+    return solved;
+}
+
+template<int Q>
+void RollingHorizon<Q>::print_race_summary() const
+{
+    std::cout << MANJ_GREEN << "Races: " << FORMAT_STOP << std::endl;
+    for (int k = 0; k < num_race_configs; ++k)
+        std::cout << "  " << race_names[k] << ": " << race_wins[k] << "/" << race_entries[k] << " won" << std::endl;
+}
+
+template class RollingHorizon<3>;
+template class RollingHorizon<6>;
@@ -0,0 +1,179 @@
+#include "DARPH.h"
+#include "RollingHorizon.h"
+
+template<int Q>
+void RollingHorizon<Q>::set_robustness(int scenarios, double time_limit, int threads)
+{
+    robustness_scenarios = scenarios;
+    robustness_time = time_limit;
+    robustness_threads = DARPH_MAX(1, threads);
+}
+
+template<int Q>
+void RollingHorizon<Q>::simulate_delays(DARP& D, const std::vector<std::vector<int>>& routes, const std::vector<int>& open, int scenario, std::vector<double>& begin, RobustnessCount& count) const
+{
+    ///
+    /// one delay scenario: every leg of the open part of a route is delayed as drawn from the delay model for
+    /// (seed, iteration, leg, scenario), the vehicle starts service as planned or as soon as it arrives if it is late,
+    /// i.e. waiting time in the plan absorbs delays; counts violations of time windows, maximum ride times and promises
+    ///
+    bool scenario_violated = false;
+    for (unsigned int r = 0; r < routes.size(); ++r)
+    {
+        const std::vector<int>& route = routes[r];
+        bool vehicle_violated = false;
+        // the vehicle has left for the events before open, they take place as planned
+        for (int k = 0; k < open[r]; ++k)
+            begin[route[k]] = D.nodes[route[k]].beginning_service;
+        for (int k = open[r]; k < int(route.size()); ++k)
+        {
+            const int i = route[k];
+            const int from = (k > 0) ? route[k-1] : DARPH_DEPOT;
+            double arrival = D.nodes[i].beginning_service;
+            if (k > 0)
+                arrival = begin[from] + D.nodes[from].service_time + D.tt[from][i];
+            arrival += delay_model->sample(sim_seed, num_milps, from, i, scenario, D.tt[from][i], D.nodes[i].beginning_service - D.tt[from][i]);
+            begin[i] = DARPH_MAX(D.nodes[i].beginning_service, arrival);
+
+            bool violated = false;
+            if (begin[i] > D.nodes[i].end_tw + DARPH_EPSILON)
+            {
+                count.time_window++;
+                violated = true;
+            }
+            if (i > n && begin[i] - begin[i-n] - D.nodes[i-n].service_time > D.nodes[i].max_ride_time + DARPH_EPSILON)
+            {
+                count.ride_time++;
+                violated = true;
+            }
+            if (i <= n && begin[i] > communicated_pickup[i-1] + pickup_delay_param + DARPH_EPSILON)
+            {
+                count.promise++;
+                violated = true;
+            }
+            if (violated)
+            {
+                count.request[(i <= n) ? i : i-n]++;
+                vehicle_violated = true;
+            }
+        }
+        if (vehicle_violated)
+        {
+            count.vehicle[r]++;
+            scenario_violated = true;
+        }
+    }
+    if (scenario_violated)
+        count.any++;
+    count.scenarios++;
+}
+
+template<int Q>
+void RollingHorizon<Q>::evaluate_robustness(DARP& D)
+{
+    ///
+    /// Monte Carlo evaluation of the current routes against delays: up to robustness_scenarios scenarios are
+    /// simulated in parallel within robustness_time seconds, the share of scenarios with a violation
+    /// is reported per request and per vehicle; scenario s is the same for any number of threads
+    ///
+    const auto before = clock::now();
+    std::vector<std::vector<int>> routes;
+    collect_routes(D, routes);
+    std::vector<int> open;
+    for (const auto& route: routes)
+        open.push_back(first_open(D, route));
+
+    std::vector<RobustnessCount> counts(robustness_threads);
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < robustness_threads; ++t)
+    {
+        workers.push_back(std::thread([&, t]() {
+            RobustnessCount& count = counts[t];
+            count.request.assign(n+1, 0);
+            count.vehicle.assign(routes.size(), 0);
+            std::vector<double> begin(2*n+1, 0);
+            int scenario;
+            while ((scenario = next++) < robustness_scenarios && sec(clock::now() - before).count() < robustness_time)
+                simulate_delays(D, routes, open, scenario, begin, count);
+        }));
+    }
+    for (auto& worker: workers)
+        worker.join();
+
+    RobustnessCount total;
+    total.request.assign(n+1, 0);
+    total.vehicle.assign(routes.size(), 0);
+    for (const auto& count: counts)
+    {
+        total.scenarios += count.scenarios;
+        total.any += count.any;
+        total.time_window += count.time_window;
+        total.ride_time += count.ride_time;
+        total.promise += count.promise;
+        for (int i = 1; i <= n; ++i)
+            total.request[i] += count.request[i];
+        for (unsigned int r = 0; r < routes.size(); ++r)
+            total.vehicle[r] += count.vehicle[r];
+    }
+    if (total.scenarios == 0)
+        return;
+
+    request_violation.assign(n+1, 0);
+    for (int i = 1; i <= n; ++i)
+        request_violation[i] = double(total.request[i]) / total.scenarios;
+    vehicle_violation.assign(routes.size(), 0);
+    for (unsigned int r = 0; r < routes.size(); ++r)
+        vehicle_violation[r] = double(total.vehicle[r]) / total.scenarios;
+
+    const double probability = double(total.any) / total.scenarios;
+    robustness_sum += probability;
+    robustness_runs++;
+    std::cout << MANJ_GREEN << "Robustness: " << FORMAT_STOP << total.scenarios << " scenarios in " << sec(clock::now() - before).count() << "s, violation probability " << probability;
+    std::cout << " (time windows " << total.time_window << ", ride times " << total.ride_time << ", promises " << total.promise << " violated)" << std::endl;
+    std::cout << "  vehicles:";
+    for (unsigned int r = 0; r < routes.size(); ++r)
+        std::cout << " " << vehicle_violation[r];
+    std::cout << std::endl;
+#if VERBOSE
+    for (int i = 1; i <= n; ++i)
+    {
+        if (request_violation[i] > 0)
+            std::cout << "  request " << i << ": " << request_violation[i] << std::endl;
+    }
+#endif
+}
+
+template<int Q>
+double RollingHorizon<Q>::arc_buffer(DARP& D, DARPGraph<Q>& G, const ARC& a)
+{
+    ///
+    /// slack added to the travel time of arc a: the robust_quantile-quantile of robust_scenarios delays of its leg
+    /// sampled from the delay model (iteration 0 is not used by the realized delays), the arcs of a leg share
+    /// the buffer; no buffer on the way back to the depot since no promise depends on it
+    ///
+    if (robust_quantile <= 0 || !delay_model || a[1] == G.depot)
+        return 0;
+    const int from = a[0][0];
+    const int to = a[1][0];
+    const uint64_t leg = uint64_t(from) * (2*n+1) + to;
+    auto it = delay_buffers.find(leg);
+    if (it == delay_buffers.end())
+    {
+        std::vector<double> delays(robust_scenarios);
+        for (int k = 0; k < robust_scenarios; ++k)
+            delays[k] = delay_model->sample(sim_seed, 0, from, to, k, D.tt[from][to], D.nodes[to].start_tw - D.tt[from][to]);
+        const int q = DARPH_MIN(int(robust_quantile * robust_scenarios), robust_scenarios - 1);
+        std::nth_element(delays.begin(), delays.begin() + q, delays.end());
+        it = delay_buffers.emplace(leg, delays[q]).first;
+    }
+    if (it->second > 0)
+    {
+        buffered_arcs++;
+        buffer_sum += it->second;
+    }
+    return it->second;
+}
+
+template class RollingHorizon<3>;
+template class RollingHorizon<6>;
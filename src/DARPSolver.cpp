@@ -86,13 +86,16 @@ void DARPSolver::check_paths(DARP& D)
         f[0][i][1] = 1;
     }
     
-    for (const auto& i: D.R)
+    // row t_j of the travel times read once for all pairs (i,j)
+    DistanceProvider::RowBuffer tt_row(D.tt);
+    for (const auto& j: D.R)
     {
-        for (const auto& j: D.R)
+        const double* t_j = tt_row(j);
+        for (const auto& i: D.R)
         {
             if (j != i)
             {
-                if (D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i] > D.nodes[i].end_tw || (D.nodes[i].demand + D.nodes[j].demand > D.veh_capacity))
+                if (D.nodes[j].start_tw + D.nodes[j].service_time + t_j[i] > D.nodes[i].end_tw || (D.nodes[i].demand + D.nodes[j].demand > D.veh_capacity))
                 {
                     f[i][j][0] = 0;
                     f[i][j][1] = 0;
@@ -133,55 +136,82 @@ void DARPSolver::check_paths(DARP& D)
 }
 
 
-void DARPSolver::check_new_paths(DARP& D, double w1, double w2, double w3)
+void DARPSolver::check_new_path(DARP& D, int i, int j, double w1, double w3)
 {
+    ///
+    /// check feasibility of the paths j --- i --- n+j --- n+i and j --- i --- n+i --- n+j for a request j that has not been picked up yet
+    ///
     DARPRoute path;
-    for (const auto& i: all_seekers)
+    if (D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i] > D.nodes[i].end_tw || (D.nodes[i].demand + D.nodes[j].demand > D.veh_capacity))
     {
-        for (const auto& j: new_requests)
+        f[i][j][0] = 0;
+        f[i][j][1] = 0;
+    }
+    else 
+    {
+        // test path 0
+        // j --- i --- n+j --- n+i
+        path.start = j;
+        D.next_array[j] = i;
+        D.next_array[i] = n+j;
+        D.next_array[n+j] = n+i;
+        D.next_array[n+i] = -1; // mark the end of the path
+        path.end = n+i;
+
+        if (eight_step(D, path))
         {
-            if (D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i] > D.nodes[i].end_tw || (D.nodes[i].demand + D.nodes[j].demand > D.veh_capacity))
-            {
-                f[i][j][0] = 0;
-                f[i][j][1] = 0;
-            }
-            else 
-            {
-                // test path 0
-                // j --- i --- n+j --- n+i
-                path.start = j;
-                D.next_array[j] = i;
-                D.next_array[i] = n+j;
-                D.next_array[n+j] = n+i;
-                D.next_array[n+i] = -1; // mark the end of the path
-                path.end = n+i;
+            f[i][j][0] = 1;
+            incremental_costs[i][j][0] = w1 * (D.d[j][i] + D.d[i][n+j] + D.d[n+j][n+i]) + w3 * (2 * (DARPH_MAX(D.nodes[i].start_tw, D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i]) + D.nodes[i].service_time + D.tt[i][n+j]) - D.nodes[n+j].start_tw + D.nodes[n+j].service_time + D.tt[n+j][n+i] - D.nodes[n+i].start_tw);
+        }
+        else
+            f[i][j][0] = 0;
+        
+        // test path 1
+        // j --- i --- n+i --- n+j
+        path.start = j;
+        D.next_array[j] = i;
+        D.next_array[i] = n+i;
+        D.next_array[n+i] = n+j;
+        D.next_array[n+j] = -1;
+        path.end = n+j;
+
+        if (eight_step(D, path))
+        {
+            f[i][j][1] = 1;
+            incremental_costs[i][j][1] = w1 * (D.d[j][i] + D.d[i][n+i] + D.d[n+i][n+j]) + w3 * (2 * (DARPH_MAX(D.nodes[i].start_tw, D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i]) + D.nodes[i].service_time + D.tt[i][n+i]) - D.nodes[n+i].start_tw + D.nodes[n+i].service_time + D.tt[n+i][n+j] - D.nodes[n+j].start_tw);
+        }
+        else
+            f[i][j][1] = 0;  
+    }
+}
 
-                if (eight_step(D, path))
-                {
-                    f[i][j][0] = 1;
-                    incremental_costs[i][j][0] = w1 * (D.d[j][i] + D.d[i][n+j] + D.d[n+j][n+i]) + w3 * (2 * (DARPH_MAX(D.nodes[i].start_tw, D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i]) + D.nodes[i].service_time + D.tt[i][n+j]) - D.nodes[n+j].start_tw + D.nodes[n+j].service_time + D.tt[n+j][n+i] - D.nodes[n+i].start_tw);
-                }
-                else
-                    f[i][j][0] = 0;
-                
-                // test path 1
-                // j --- i --- n+i --- n+j
-                path.start = j;
-                D.next_array[j] = i;
-                D.next_array[i] = n+i;
-                D.next_array[n+i] = n+j;
-                D.next_array[n+j] = -1;
-                path.end = n+j;
+void DARPSolver::precheck_new_paths(DARP& D, const std::vector<int>& known, const std::vector<int>& requests, double w1, double w3)
+{
+    ///
+    /// check the paths of requests against the known requests before the status of the known requests is determined
+    /// check_new_paths() then only has to treat the requests that have been picked up in the meantime
+    ///
+    for (const auto& i: known)
+    {
+        for (const auto& j: requests)
+        {
+            check_new_path(D, i, j, w1, w3);
+            check_new_path(D, j, i, w1, w3);
+        }
+    }
+}
 
-                if (eight_step(D, path))
-                {
-                    f[i][j][1] = 1;
-                    incremental_costs[i][j][1] = w1 * (D.d[j][i] + D.d[i][n+i] + D.d[n+i][n+j]) + w3 * (2 * (DARPH_MAX(D.nodes[i].start_tw, D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i]) + D.nodes[i].service_time + D.tt[i][n+i]) - D.nodes[n+i].start_tw + D.nodes[n+i].service_time + D.tt[n+i][n+j] - D.nodes[n+j].start_tw);
-                }
-                else
-                    f[i][j][1] = 0;  
-            }
-        }   
+void DARPSolver::check_new_paths(DARP& D, double w1, double w2, double w3, bool prechecked)
+{
+    DARPRoute path;
+    // pairs of seekers and new requests have already been checked by precheck_new_paths()
+    if (!prechecked)
+    {
+        for (const auto& i: all_seekers)
+        {
+            for (const auto& j: new_requests)
+                check_new_path(D, i, j, w1, w3);
+        }
     }
     for (const auto& i: all_picked_up)
     {
@@ -192,51 +222,12 @@ void DARPSolver::check_new_paths(DARP& D, double w1, double w2, double w3)
         }
     }
 
-    for (const auto & i: new_requests)
+    if (!prechecked)
     {
-        for (const auto& j: all_seekers)
+        for (const auto & i: new_requests)
         {
-            if (D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i] > D.nodes[i].end_tw || (D.nodes[i].demand + D.nodes[j].demand > D.veh_capacity))
-            {
-                f[i][j][0] = 0;
-                f[i][j][1] = 0;
-            }
-            else
-            {
-                // test path 0
-                // j --- i --- n+j --- n+i
-                path.start = j;
-                D.next_array[j] = i;
-                D.next_array[i] = n+j;
-                D.next_array[n+j] = n+i;
-                D.next_array[n+i] = -1; // mark the end of the path
-                path.end = n+i;
-                
-                if (eight_step(D, path))
-                {
-                    f[i][j][0] = 1;
-                    incremental_costs[i][j][0] = w1 * (D.d[j][i] + D.d[i][n+j] + D.d[n+j][n+i]) + w3 * (2 * (DARPH_MAX(D.nodes[i].start_tw, D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i]) + D.nodes[i].service_time + D.tt[i][n+j]) - D.nodes[n+j].start_tw + D.nodes[n+j].service_time + D.tt[n+j][n+i] - D.nodes[n+i].start_tw);
-                }    
-                else
-                    f[i][j][0] = 0;
-                
-                // test path 1
-                // j --- i --- n+i --- n+j
-                path.start = j;
-                D.next_array[j] = i;
-                D.next_array[i] = n+i;
-                D.next_array[n+i] = n+j;
-                D.next_array[n+j] = -1;
-                path.end = n+j;
-
-                if (eight_step(D, path))
-                {
-                    f[i][j][1] = 1;
-                    incremental_costs[i][j][1] = w1 * (D.d[j][i] + D.d[i][n+i] + D.d[n+i][n+j]) + w3 * (2 * (DARPH_MAX(D.nodes[i].start_tw, D.nodes[j].start_tw + D.nodes[j].service_time + D.tt[j][i]) + D.nodes[i].service_time + D.tt[i][n+i]) - D.nodes[n+i].start_tw + D.nodes[n+i].service_time + D.tt[n+i][n+j] - D.nodes[n+j].start_tw);
-                }    
-                else
-                    f[i][j][1] = 0;  
-            }  
+            for (const auto& j: all_seekers)
+                check_new_path(D, i, j, w1, w3);
         }
     }
 
@@ -522,16 +513,17 @@ bool DARPSolver::update_vertices(DARP& D, DARPRoute& path, int j)
 
 
 
-bool DARPSolver::eight_step(DARP& D, DARPRoute& path, int j)
+bool DARPSolver::eight_step(DARP& D, DARPRoute& path, int j, double earliest_departure)
 {
     ///
     /// MODIFIED TO CHECK feasibility of user pairs i, j going in from node j, i.e. the departure time at node j is fixed
     /// evaluation of route veh using the 8-step evaluation scheme 
     /// by Cordeau and Laporte (2003)
+    /// the vehicle does not leave node j before earliest_departure (e.g. the current time)
     ///
 
     // Step 1 
-    D.nodes[j].departure_time = D.nodes[j].beginning_service + D.nodes[j].service_time;
+    D.nodes[j].departure_time = DARPH_MAX(D.nodes[j].beginning_service + D.nodes[j].service_time, earliest_departure);
       
     // Step 2 - compute A_i, W_i, B_i and D_i for each vertex v_i in the route
     // if infeasibility is detected during the computation of an "earliest possible"-schedule, return false
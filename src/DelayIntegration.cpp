@@ -3,105 +3,111 @@
 
 
 template <int Q>
-DelayIntegration<Q>::DelayIntegration(double probability, double delay, TerminalOutputFormatter<Q>* tof) {
-    this->probability = probability;
-    this->delay = delay;
+DelayIntegration<Q>::DelayIntegration(const DelayModel* model, TerminalOutputFormatter<Q>* tof) {
+    this->model = model;
     this->tof = tof;
 }
 
 template <int Q>
 void DelayIntegration<Q>::incorporate_delay(std::stringstream& name,
+                                const DARP& D,
                                 IloEnv& env, 
                                 IloModel& model, 
                                 IloNumVarArray& B, 
                                 IloRangeArray& fixed_B, 
-                                std::vector<ARC> fixed_edges,
+                                const std::vector<ARC>& fixed_edges,
                                 std::pair<NODE,double>* active_node,
-                                std::unordered_map <NODE,uint64_t,HashFunction<Q>> vmap,
+                                const std::unordered_map <NODE,uint64_t,HashFunction<Q>>& vmap,
                                 const double epsilon,
                                 int n) 
 {
-    std::map <NODE, double> node_delay;
+    std::unordered_map <NODE, double, HashFunction<Q>> node_delay;
 
-    std::sort(fixed_edges.begin(), fixed_edges.end(),
-        [active_node](const ARC& a, const ARC& b) {
-            return active_node[a[1][0]-1].second < active_node[b[1][0]-1].second;
+    // index the fixed edges by their start event once, the fixed edges of a vehicle form a chain
+    std::unordered_map <NODE, const ARC*, HashFunction<Q>> successor;
+    std::unordered_map <NODE, bool, HashFunction<Q>> has_predecessor;
+    for (const auto& a: fixed_edges)
+    {
+        successor[a[0]] = &a;
+        has_predecessor[a[1]] = true;
+    }
+
+    // walk every chain from its first edge: each edge is visited once and after its predecessor
+    std::vector<const ARC*> order;
+    order.reserve(fixed_edges.size());
+    for (const auto& a: fixed_edges)
+    {
+        if (has_predecessor.count(a[0]))
+            continue;
+        for (const ARC* e = &a; e != nullptr; )
+        {
+            order.push_back(e);
+            const auto next = successor.find((*e)[1]);
+            e = (next != successor.end()) ? next->second : nullptr;
         }
-    );
+    }
+
     for(int i = 0; i < tof->get_current_terminal_width(); i++) {
         std::cout << "_";
     }
     std::cout << std::endl << MANJ_GREEN << "FIXED EDGES: " << FORMAT_STOP << std::endl;
+    iteration++;
 
     // fix variable B_w for new fixed d 
-    for (const auto& a: fixed_edges)
+    for (const ARC* e: order)
     {
+        const ARC& a = *e;
         if constexpr (Q==3)
             name << "fixed_B_(" << a[1][0] << "," << a[1][1] << "," << a[1][2] << ")";
         else
             name << "fixed_B_(" << a[1][0] << "," << a[1][1] << "," << a[1][2] << "," << a[1][3] << "," << a[1][4] << "," << a[1][5] << ")";
 
-        NODE from = a[0];
-        NODE to = a[1];
-        int passengerFrom = from[0] - 1;
+        const NODE& from = a[0];
+        const NODE& to = a[1];
         int passengerTo = to[0] - 1;
         
-        if (probability == 1 || dis(gen) <= probability) {
+        double& toEventTime = active_node[passengerTo].second;
+        // the leg is started at the planned time, travel time before to
+        const double start = toEventTime - D.tt[from[0]][to[0]];
+        const double delay = replay ? replay->realize(iteration, from[0], to[0], start) : this->model->sample(seed_value, iteration, from[0], to[0], 0, D.tt[from[0]][to[0]], start);
+        if (delay > 0) {
             std::cout << tof->get_printable_node(MANJ_GREEN, from, n) << " -> " << tof->get_printable_node(MANJ_GREEN, to, n);
             std::cout << " RANDOM delay of " << tof->convertDoubleToMinutes(delay) << " min\n";
-            node_delay[to] += delay;
+            if (trace)
+                trace->record_delay(iteration, from[0], to[0], delay);
         } else {
             std::cout << tof->get_printable_node(MANJ_GREEN, from, n) << " -> " << tof->get_printable_node(MANJ_GREEN, to, n);
             std::cout << " no independent delay\n";
         }
-        
-        //(to oder delayed_nodes[to]) und delayed_nodes übergeben
-        propagate_delay(to, node_delay, fixed_edges, n);
 
-        double& toEventTime = active_node[passengerTo].second;
-        toEventTime += node_delay[to];
-        
+        // realized time: the vehicle leaves from after its realized service and waits if it arrives early,
+        // so waiting time and delay buffers in the plan absorb delays; the predecessor of to has been visited already.
+        // A vehicle leaves the depot just in time, a delay on the first leg is not absorbed
+        const double planned = toEventTime;
+        if (from[0] == DARPH_DEPOT)
+            toEventTime = planned + delay;
+        else
+        {
+            const double departure = active_node[from[0] - 1].second + D.nodes[from[0]].service_time;
+            toEventTime = DARPH_MAX(planned, departure + D.tt[from[0]][to[0]] + delay);
+        }
+        node_delay[to] = toEventTime - planned;
+
         std::cout << "\t" << tof->get_printable_node(MANJ_GREEN, to, n);
         std::cout  << " TOTAL delay of " << tof->convertDoubleToMinutes(node_delay[to]) << " min\n";
 
-        fixed_B[vmap[to]] = IloRange(env,
+        const uint64_t index = vmap.at(to);
+        fixed_B[index] = IloRange(env,
                                     toEventTime - epsilon, 
-                                    B[vmap[to]], 
+                                    B[index], 
                                     toEventTime + epsilon, 
                                     name.str().c_str());
         
-        model.add(fixed_B[vmap[to]]);
+        model.add(fixed_B[index]);
         name.str("");  
     }
 }
 
-template <int Q>
-void DelayIntegration<Q>::propagate_delay(NODE delayed_event, 
-                        std::map<NODE, double> &node_delay, 
-                        std::vector<ARC> fixed_edges, 
-                        int n) 
-{
-    for (const auto& fixed_arc: fixed_edges)
-    {
-        NODE start_event = fixed_arc[0];
-        NODE dest_event = fixed_arc[1];
-
-        if(start_event == delayed_event) {
-
-            if(node_delay[delayed_event] == 0) {
-                std::cout << "\t" << tof->get_printable_node(MANJ_GREEN, start_event, n) << " propagated ZERO delay to ";
-                std::cout << tof->get_printable_node(MANJ_GREEN, dest_event, n) << std::endl;
-                return;
-            }
-            std::cout << "\t" << tof->get_printable_node(MANJ_GREEN, start_event, n) << " propagated delay of ";
-            std::cout << tof->convertDoubleToMinutes(node_delay[delayed_event]) << " min to ";
-            std::cout << tof->get_printable_node(MANJ_GREEN, dest_event, n) << std::endl;
-
-            node_delay[dest_event] += node_delay[delayed_event];
-            return;
-        }
-    }
-}
 /*Alternative mit späterem Aufruf 
 template<int Q>
 void RollingHorizon<Q>::propagate_delay_after_fixing(std::map<NODE, double>& delayed_nodes) {
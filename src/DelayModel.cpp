@@ -0,0 +1,105 @@
+#include "DARPH.h"
+
+std::array<uint32_t,4> Philox::generate(std::array<uint32_t,4> counter, std::array<uint32_t,2> key)
+{
+    // ten rounds of multiplication, key schedule by the Weyl sequence W0, W1
+    for (int round = 0; round < 10; ++round)
+    {
+        const uint64_t product0 = uint64_t(M0) * counter[0];
+        const uint64_t product1 = uint64_t(M1) * counter[2];
+        counter = {uint32_t(product1 >> 32) ^ counter[1] ^ key[0], uint32_t(product1), uint32_t(product0 >> 32) ^ counter[3] ^ key[1], uint32_t(product0)};
+        key[0] += W0;
+        key[1] += W1;
+    }
+    return counter;
+}
+
+std::array<double,4> Philox::uniform(uint32_t seed, uint32_t iteration, uint32_t from, uint32_t to, uint32_t scenario)
+{
+    const std::array<uint32_t,4> bits = generate({from, to, scenario, 0}, {seed, iteration});
+    std::array<double,4> u;
+    for (int k = 0; k < 4; ++k)
+        u[k] = (bits[k] + 0.5) / 4294967296.0;
+    return u;
+}
+
+DelayModel* DelayModel::create(int type, double probability, double delay, double mu, double sigma, const std::string& file)
+{
+    switch (type)
+    {
+        case DARPH_DELAY_LOGNORMAL:
+            return new LognormalDelay(mu, sigma);
+        case DARPH_DELAY_TIME_OF_DAY:
+            return new TimeOfDayDelay(file);
+        case DARPH_DELAY_EMPIRICAL:
+            return new EmpiricalDelay(file);
+        default:
+            return new FixedDelay(probability, delay);
+    }
+}
+
+double FixedDelay::sample(const std::array<double,4>& u, double travel_time, double time) const
+{
+    return (probability == 1 || u[0] <= probability) ? delay : 0;
+}
+
+double LognormalDelay::sample(const std::array<double,4>& u, double travel_time, double time) const
+{
+    // standard normal by Box-Muller, the leg is only delayed if the factor exceeds 1
+    const double z = std::sqrt(-2 * std::log(u[0])) * std::cos(2 * M_PI * u[1]);
+    return DARPH_PLUS(travel_time * (std::exp(mu + sigma * z) - 1));
+}
+
+TimeOfDayDelay::TimeOfDayDelay(const std::string& file)
+{
+    ///
+    /// one line per period: start of the period [min], probability and delay [min] of a leg started in this period
+    ///
+    std::ifstream infile(file);
+    if (!infile)
+        report_error("%s: cannot open %s\n", __FUNCTION__, file.c_str());
+    std::array<double,3> period;
+    while (infile >> period[0] >> period[1] >> period[2])
+        profile.push_back(period);
+    if (profile.empty())
+        report_error("%s: no period in %s\n", __FUNCTION__, file.c_str());
+    std::sort(profile.begin(), profile.end());
+}
+
+double TimeOfDayDelay::sample(const std::array<double,4>& u, double travel_time, double time) const
+{
+    // last period started before time, legs before the first period are delayed as in the first one
+    auto period = std::upper_bound(profile.begin(), profile.end(), time, [](double t, const std::array<double,3>& p) {return t < p[0];});
+    if (period != profile.begin())
+        --period;
+    return (u[0] <= (*period)[1]) ? (*period)[2] : 0;
+}
+
+EmpiricalDelay::EmpiricalDelay(const std::string& file)
+{
+    ///
+    /// one line per bin of the histogram: delay [min] and its (relative) frequency
+    ///
+    std::ifstream infile(file);
+    if (!infile)
+        report_error("%s: cannot open %s\n", __FUNCTION__, file.c_str());
+    double delay, frequency;
+    double total = 0;
+    while (infile >> delay >> frequency)
+    {
+        total += frequency;
+        delays.push_back(delay);
+        cdf.push_back(total);
+    }
+    if (total <= 0)
+        report_error("%s: no frequencies in %s\n", __FUNCTION__, file.c_str());
+    for (auto& c: cdf)
+        c /= total;
+}
+
+double EmpiricalDelay::sample(const std::array<double,4>& u, double travel_time, double time) const
+{
+    // inverse of the cumulative distribution
+    const int bin = std::lower_bound(cdf.begin(), cdf.end(), u[0]) - cdf.begin();
+    return delays[DARPH_MIN(bin, int(delays.size()) - 1)];
+}
@@ -0,0 +1,144 @@
+#include "DARPH.h"
+
+void DelayTrace::open(const std::string& file)
+{
+    out.open(file, std::ios::binary);
+    if (!out)
+        report_error("%s: cannot open %s\n", __FUNCTION__, file.c_str());
+    out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+}
+
+void DelayTrace::write(Record type, uint32_t iteration, int from, int to, double value)
+{
+    const uint8_t t = type;
+    const int32_t f = from;
+    const int32_t e = to;
+    out.write(reinterpret_cast<const char*>(&t), sizeof(t));
+    out.write(reinterpret_cast<const char*>(&iteration), sizeof(iteration));
+    out.write(reinterpret_cast<const char*>(&f), sizeof(f));
+    out.write(reinterpret_cast<const char*>(&e), sizeof(e));
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+ReplayDelay::ReplayDelay(const std::string& file)
+{
+    ///
+    /// read all records at once, a file without the magic number is read as text log
+    ///
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        report_error("%s: cannot open %s\n", __FUNCTION__, file.c_str());
+    uint32_t head[2] = {0, 0};
+    in.read(reinterpret_cast<char*>(head), sizeof(head));
+    if (!in || head[0] != DelayTrace::magic)
+    {
+        in.close();
+        read_text(file);
+        return;
+    }
+    if (head[1] != DelayTrace::version)
+        report_error("%s: %s has version %u, expected %u\n", __FUNCTION__, file.c_str(), head[1], DelayTrace::version);
+
+    uint8_t type;
+    uint32_t iteration;
+    int32_t from, to;
+    double value;
+    while (in.read(reinterpret_cast<char*>(&type), sizeof(type))
+        && in.read(reinterpret_cast<char*>(&iteration), sizeof(iteration))
+        && in.read(reinterpret_cast<char*>(&from), sizeof(from))
+        && in.read(reinterpret_cast<char*>(&to), sizeof(to))
+        && in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+    {
+        if (type == DelayTrace::reveal)
+            reveals[from] = value;
+        else if (delays.count(key(iteration, from, to)))
+            entries[delays[key(iteration, from, to)]].delay += value;
+        else
+        {
+            delays[key(iteration, from, to)] = entries.size();
+            entries.push_back({0, value});
+        }
+    }
+    used.assign(entries.size(), false);
+}
+
+void ReplayDelay::read_text(const std::string& file)
+{
+    std::ifstream in(file);
+    std::string type;
+    while (in >> type)
+    {
+        if (type == "r")
+        {
+            int i;
+            double time;
+            if (in >> i >> time)
+                reveals[i] = time;
+        }
+        else if (type == "d")
+        {
+            int from, to;
+            double time, delay;
+            if (in >> from >> to >> time >> delay)
+            {
+                legs[key(0, from, to)].push_back(entries.size());
+                entries.push_back({time, delay});
+            }
+        }
+        else
+            report_error("%s: unknown record %s in %s\n", __FUNCTION__, type.c_str(), file.c_str());
+    }
+    for (auto& leg: legs)
+        std::sort(leg.second.begin(), leg.second.end(), [this](int a, int b) {return entries[a].time < entries[b].time;});
+    used.assign(entries.size(), false);
+}
+
+int ReplayDelay::find(uint32_t iteration, int from, int to, double time) const
+{
+    ///
+    /// entry of the delay of the leg from -> to started at time in the given iteration, -1 if there is none:
+    /// a trace has the delay of the iteration, a log the delay of the leg closest in time (within DARPH_REPLAY_WINDOW)
+    ///
+    if (legs.empty())
+    {
+        const auto it = delays.find(key(iteration, from, to));
+        return (it != delays.end()) ? it->second : -1;
+    }
+    const auto it = legs.find(key(0, from, to));
+    if (it == legs.end())
+        return -1;
+    const std::vector<int>& leg = it->second;
+    const auto next = std::lower_bound(leg.begin(), leg.end(), time, [this](int k, double t) {return entries[k].time < t;});
+    int best = -1;
+    if (next != leg.end())
+        best = *next;
+    if (next != leg.begin() && (best < 0 || time - entries[*(next - 1)].time < entries[best].time - time))
+        best = *(next - 1);
+    return (best >= 0 && std::abs(entries[best].time - time) <= DARPH_REPLAY_WINDOW) ? best : -1;
+}
+
+double ReplayDelay::sample(uint32_t seed, uint32_t iteration, int from, int to, uint32_t scenario, double travel_time, double time) const
+{
+    const int k = find(iteration, from, to, time);
+    return (k >= 0) ? entries[k].delay : 0;
+}
+
+double ReplayDelay::realize(uint32_t iteration, int from, int to, double time) const
+{
+    // as sample, the delay is counted as replayed
+    const int k = find(iteration, from, to, time);
+    if (k < 0)
+        return 0;
+    used[k] = true;
+    return entries[k].delay;
+}
+
+bool ReplayDelay::reveal_time(int i, double& time) const
+{
+    const auto it = reveals.find(i);
+    if (it == reveals.end())
+        return false;
+    time = it->second;
+    return true;
+}
@@ -0,0 +1,245 @@
+#include "DARPH.h"
+
+DistanceProvider::~DistanceProvider()
+{
+    release();
+}
+
+void DistanceProvider::release()
+{
+    if (owner)
+        delete[] storage;
+    storage = nullptr;
+    owner = false;
+    singles.reset();
+    centis.reset();
+    single_data = nullptr;
+    centi_data = nullptr;
+    x.clear();
+    y.clear();
+    cache_id = 0;
+}
+
+void DistanceProvider::dense(int dimension)
+{
+    release();
+    type = DARPH_DISTANCE_DENSE;
+    this->dimension = dimension;
+    storage = new double[size_t(dimension) * dimension];
+    owner = true;
+}
+
+void DistanceProvider::map(int dimension, double* data)
+{
+    // the storage belongs to the mapping of a compiled instance
+    release();
+    type = DARPH_DISTANCE_DENSE;
+    this->dimension = dimension;
+    storage = data;
+}
+
+bool DistanceProvider::compress(int format)
+{
+    ///
+    /// replace the dense double matrix by float32 or 16-bit fixed-point values if every entry is
+    /// reproduced bit for bit, i.e. get() returns the same double as before; false if not
+    /// (storage unchanged). Fixed-point values are decoded as the nearest double to c/100 or,
+    /// for travel times rounded in float, as float(c)/100 (roundf(t * 100) / 100 in DARP.cpp)
+    ///
+    if (!storage || format == DARPH_COMPACT_NONE)
+        return false;
+    const size_t size = size_t(dimension) * dimension;
+    if (format == DARPH_COMPACT_FLOAT)
+    {
+        auto values = std::make_shared<std::vector<float>>(size);
+        for (size_t k = 0; k < size; ++k)
+        {
+            (*values)[k] = float(storage[k]);
+            if (double((*values)[k]) != storage[k])
+                return false;
+        }
+        release();
+        singles = values;
+        single_data = singles->data();
+        return true;
+    }
+
+    // the same decoding has to work for all entries
+    auto values = std::make_shared<std::vector<uint16_t>>(size);
+    bool exact[2] = {true, true};
+    for (size_t k = 0; k < size && (exact[0] || exact[1]); ++k)
+    {
+        const double c = std::round(storage[k] * 100);
+        if (c < 0 || c > UINT16_MAX)
+            return false;
+        (*values)[k] = uint16_t(c);
+        exact[0] = exact[0] && (c / 100.0 == storage[k]);
+        exact[1] = exact[1] && (double(float(c) / 100) == storage[k]);
+    }
+    if (!exact[0] && !exact[1])
+        return false;
+    release();
+    float_rounded = !exact[0];
+    centis = values;
+    centi_data = centis->data();
+    return true;
+}
+
+void DistanceProvider::computed(const DARPNode* nodes, int dimension, int type)
+{
+    ///
+    /// distances computed from the coordinates of nodes[0..dimension-1] on every access;
+    /// DARPH_DISTANCE_AUTO chooses a dense matrix if it needs at most DARPH_DENSE_LIMIT bytes
+    ///
+    release();
+    if (type == DARPH_DISTANCE_AUTO)
+        type = (sizeof(double) * dimension * dimension <= DARPH_DENSE_LIMIT) ? DARPH_DISTANCE_DENSE : DARPH_DISTANCE_TILED;
+    this->dimension = dimension;
+    x.resize(dimension);
+    y.resize(dimension);
+    for (int i = 0; i < dimension; ++i)
+    {
+        x[i] = nodes[i].x;
+        y[i] = nodes[i].y;
+    }
+    this->type = type;
+    if (type == DARPH_DISTANCE_DENSE)
+    {
+        // computed before storage is set, fill_row would copy from it otherwise
+        double* values = new double[size_t(dimension) * dimension];
+        for (int i = 0; i < dimension; ++i)
+            fill_row(i, 0, dimension, values + size_t(i) * dimension);
+        storage = values;
+        owner = true;
+        x.clear();
+        y.clear();
+    }
+    else if (type == DARPH_DISTANCE_TILED)
+    {
+        static std::atomic<uint64_t> next_id{1};
+        cache_id = next_id++;
+    }
+}
+
+void DistanceProvider::alias(const DistanceProvider& other)
+{
+    // same values without a copy of the matrix, e.g. tt = d in instance mode 1
+    release();
+    type = other.type;
+    dimension = other.dimension;
+    storage = other.storage;
+    singles = other.singles;
+    centis = other.centis;
+    single_data = other.single_data;
+    centi_data = other.centi_data;
+    float_rounded = other.float_rounded;
+    x = other.x;
+    y = other.y;
+    cache_id = other.cache_id;
+}
+
+void DistanceProvider::place(const DARPNode* nodes, int k)
+{
+    ///
+    /// node k has moved to new coordinates (e.g. a new request in a reserved slot): row and column k of an owned
+    /// dense matrix are computed again, the computed backend takes the coordinates; shared storage is left
+    /// to its owner. Only for matrices computed from coordinates, without tiles and not compact
+    ///
+    if (is_compact() || type == DARPH_DISTANCE_TILED)
+        report_error("%s: node %d cannot be placed in a compact or tiled matrix\n", __FUNCTION__, k);
+    if (storage)
+    {
+        if (!owner)
+            return;
+        for (int j = 0; j < dimension; ++j)
+        {
+            const double val = sqrt((nodes[k].x - nodes[j].x) * (nodes[k].x - nodes[j].x) + (nodes[k].y - nodes[j].y) * (nodes[k].y - nodes[j].y));
+            storage[size_t(k) * dimension + j] = roundf(val * 100) / 100;
+            storage[size_t(j) * dimension + k] = roundf(val * 100) / 100;
+        }
+        return;
+    }
+    x[k] = nodes[k].x;
+    y[k] = nodes[k].y;
+}
+
+double DistanceProvider::compute(int i, int j) const
+{
+    const double val = sqrt((x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]));
+    return roundf(val * 100) / 100;
+}
+
+void DistanceProvider::fill_row(int i, int first, int last, double* out) const
+{
+    ///
+    /// out[j-first] = M[i][j] for first <= j < last; the computation has no dependency
+    /// between the entries and no branch, so the compiler can vectorize sqrt and rounding
+    ///
+    if (storage)
+    {
+        std::copy(storage + size_t(i) * dimension + first, storage + size_t(i) * dimension + last, out);
+        return;
+    }
+    if (is_dense())
+    {
+        for (int j = first; j < last; ++j)
+            out[j - first] = get(i, j);
+        return;
+    }
+    const double xi = x[i];
+    const double yi = y[i];
+    const double* xs = x.data();
+    const double* ys = y.data();
+    for (int j = first; j < last; ++j)
+    {
+        const double val = sqrt((xi - xs[j]) * (xi - xs[j]) + (yi - ys[j]) * (yi - ys[j]));
+        out[j - first] = roundf(val * 100) / 100;
+    }
+}
+
+double DistanceProvider::cached(int i, int j) const
+{
+    ///
+    /// look up M[i][j] in its tile of DARPH_TILE_SIZE x DARPH_TILE_SIZE entries, a tile is computed
+    /// row by row when it is not in its slot; every thread (tabu search, robustness evaluation, ...)
+    /// has a direct-mapped cache of its own, so the lookup needs no lock. A slot holds the tile
+    /// of one provider (cache_id), aliases share the tiles and a recomputed provider gets a new id
+    ///
+    struct Tile {
+        uint64_t id = 0;
+        long tag = -1;
+        std::vector<double> values;
+    };
+    thread_local std::vector<Tile> tiles(DARPH_TILE_SLOTS);
+
+    const int tiles_per_row = (dimension + DARPH_TILE_SIZE - 1) / DARPH_TILE_SIZE;
+    const long tag = long(i / DARPH_TILE_SIZE) * tiles_per_row + j / DARPH_TILE_SIZE;
+    Tile& tile = tiles[((uint64_t(tag) ^ (cache_id << 40)) * 0x9E3779B97F4A7C15ULL >> 32) % DARPH_TILE_SLOTS];
+    const int row = (i / DARPH_TILE_SIZE) * DARPH_TILE_SIZE;
+    const int column = (j / DARPH_TILE_SIZE) * DARPH_TILE_SIZE;
+    if (tile.tag != tag || tile.id != cache_id)
+    {
+        tile.values.resize(DARPH_TILE_SIZE * DARPH_TILE_SIZE);
+        const int last = DARPH_MIN(column + DARPH_TILE_SIZE, dimension);
+        for (int r = row; r < DARPH_MIN(row + DARPH_TILE_SIZE, dimension); ++r)
+            fill_row(r, column, last, tile.values.data() + (r - row) * DARPH_TILE_SIZE);
+        tile.id = cache_id;
+        tile.tag = tag;
+    }
+    return tile.values[(i - row) * DARPH_TILE_SIZE + (j - column)];
+}
+
+size_t DistanceProvider::memory() const
+{
+    // bytes held for the matrix, shared storage is counted for every provider and tiles for one thread
+    size_t bytes = sizeof(double) * (x.size() + y.size());
+    if (storage)
+        bytes += sizeof(double) * dimension * dimension;
+    if (singles)
+        bytes += sizeof(float) * singles->size();
+    if (centis)
+        bytes += sizeof(uint16_t) * centis->size();
+    if (type == DARPH_DISTANCE_TILED)
+        bytes += sizeof(double) * DARPH_TILE_SIZE * DARPH_TILE_SIZE * DARPH_TILE_SLOTS;
+    return bytes;
+}
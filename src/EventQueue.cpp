@@ -0,0 +1,41 @@
+#include "DARPH.h"
+
+bool EventQueue::Later::operator()(const Event& a, const Event& b) const
+{
+    // std::priority_queue puts the largest element on top, hence "later" compares greater
+    if (a.time != b.time)
+        return a.time > b.time;
+    if (a.type != b.type)
+        return a.type > b.type;
+    return a.id > b.id;
+}
+
+Event EventQueue::pop()
+{
+    Event e = queue.top();
+    queue.pop();
+    return e;
+}
+
+double EventQueue::advance(EventType type)
+{
+    ///
+    /// pop the next event of the given type and return its time (DARPH_INFINITY if there is none),
+    /// earlier events of other types stay in the queue
+    ///
+    std::vector<Event> others;
+    double time = DARPH_INFINITY;
+    while (!queue.empty())
+    {
+        Event e = pop();
+        if (e.type == type)
+        {
+            time = e.time;
+            break;
+        }
+        others.push_back(e);
+    }
+    for (const auto& e: others)
+        queue.push(e);
+    return time;
+}
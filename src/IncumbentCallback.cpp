@@ -0,0 +1,132 @@
+#include "DARPH.h"
+
+
+template <int Q>
+IncumbentCallback<Q>::IncumbentCallback(int policy, double target_gap, double stability_sec) {
+    this->policy = policy;
+    this->target_gap = target_gap;
+    this->stability_sec = stability_sec;
+    clear();
+}
+
+template <int Q>
+void IncumbentCallback<Q>::clear() {
+    watched.clear();
+    gap_trajectory.clear();
+    incumbent_obj = IloInfinity;
+    last_change = 0;
+    first_incumbent = -1;
+    last_incumbent = -1;
+    num_incumbents = 0;
+}
+
+template <int Q>
+void IncumbentCallback<Q>::watch(int request, IloNumVar p, const std::vector<std::pair<IloNumVar, std::vector<IloNumVar>>>& pickups) {
+    watched.push_back({request, p, pickups, false, -1, -1, false});
+}
+
+template <int Q>
+void IncumbentCallback<Q>::arm(clock::time_point start) {
+    this->start = start;
+}
+
+template <int Q>
+bool IncumbentCallback<Q>::all_decided() const {
+    // every new request has been answered, accepted or denied, and its first answer still holds
+    for (const auto& r: watched)
+    {
+        if (r.answered < 0 || r.revised)
+            return false;
+    }
+    return true;
+}
+
+template <int Q>
+void IncumbentCallback<Q>::invoke(const IloCplex::Callback::Context& context) {
+    if (!context.inGlobalProgress())
+        return;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    const double now = sec(clock::now() - start).count();
+    const double obj = context.getDoubleInfo(IloCplex::Callback::Context::Info::BestSolution);
+    const double bound = context.getDoubleInfo(IloCplex::Callback::Context::Info::BestBound);
+
+    if (context.getIntInfo(IloCplex::Callback::Context::Info::Feasible) && obj < incumbent_obj - DARPH_EPSILON)
+    {
+        // new incumbent: publish acceptance and pick-up time of each new request
+        incumbent_obj = obj;
+        num_incumbents++;
+        if (first_incumbent < 0)
+            first_incumbent = now;
+        last_incumbent = now;
+
+        for (auto& r: watched)
+        {
+            bool accepted = context.getIncumbentValue(r.p) > 0.9;
+            double pickup = -1;
+            if (accepted)
+            {
+                for (const auto& [B, arcs]: r.pickups)
+                {
+                    double inflow = 0;
+                    for (const auto& x: arcs)
+                        inflow += context.getIncumbentValue(x);
+                    if (inflow > 0.9)
+                    {
+                        pickup = context.getIncumbentValue(B);
+                        break;
+                    }
+                }
+            }
+            if (r.answered < 0 || accepted != r.accepted || DARPH_ABS(pickup - r.pickup) > DARPH_EPSILON)
+            {
+                r.revised = (r.answered >= 0);
+                r.accepted = accepted;
+                r.pickup = pickup;
+                r.answered = now;
+                last_change = now;
+#if VERBOSE
+                std::cout << "\tincumbent " << num_incumbents << " after " << now << "s: request " << r.request;
+                if (accepted)
+                    std::cout << " accepted, pick-up at " << pickup << std::endl;
+                else
+                    std::cout << " denied" << std::endl;
+#endif
+            }
+        }
+    }
+
+    if (num_incumbents == 0)
+        return;
+
+    double gap = DARPH_ABS(incumbent_obj - bound) / (DARPH_ABS(incumbent_obj) + 1e-10);
+    if (gap_trajectory.empty() || gap_trajectory.back().second != gap)
+        gap_trajectory.push_back(std::make_pair(now, gap));
+
+    // early-stop policy
+    if ((policy == DARPH_STOP_GAP && gap <= target_gap)
+        || (policy == DARPH_STOP_STABILITY && now - last_change >= stability_sec)
+        || (policy == DARPH_STOP_DECIDED && all_decided()))
+    {
+        context.abort();
+    }
+}
+
+template <int Q>
+bool IncumbentCallback<Q>::answer(int i, bool& accepted, double& pickup, double& answered) const {
+    for (const auto& r: watched)
+    {
+        if (r.request == i && r.answered >= 0)
+        {
+            accepted = r.accepted;
+            pickup = r.pickup;
+            answered = r.answered;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template class IncumbentCallback<3>;
+template class IncumbentCallback<6>;
@@ -0,0 +1,165 @@
+#include "DARPH.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+RequestStream::RequestStream(const std::string& source)
+{
+    if (source == "-")
+        fd = STDIN_FILENO;
+    else if (source.compare(0, 5, "unix:") == 0)
+    {
+        const std::string path = source.substr(5);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            report_error("%s: socket path %s too long\n", __FUNCTION__, path.c_str());
+        strcpy(address.sun_path, path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            report_error("%s: cannot connect to %s\n", __FUNCTION__, path.c_str());
+    }
+    else
+    {
+        // a named pipe blocks here until the writer opens it
+        fd = ::open(source.c_str(), O_RDONLY);
+        if (fd < 0)
+            report_error("%s: cannot open %s\n", __FUNCTION__, source.c_str());
+    }
+    reader = std::thread(&RequestStream::read_loop, this);
+}
+
+RequestStream::~RequestStream()
+{
+    stopping = true;
+    if (reader.joinable())
+        reader.join();
+    if (fd > STDIN_FILENO)
+        close(fd);
+}
+
+void RequestStream::read_loop()
+{
+    ///
+    /// producer: read the stream in chunks and push one record per complete line; polls with a
+    /// timeout so that the destructor can stop a reader waiting for input
+    ///
+    std::vector<char> buffer(1 << 16);
+    size_t filled = 0;
+    bool discarding = false; // rest of a line longer than the buffer
+    while (!stopping)
+    {
+        pollfd request = {fd, POLLIN, 0};
+        const int ready = ::poll(&request, 1, 100);
+        if (ready < 0 && errno != EINTR)
+            break;
+        if (ready <= 0)
+            continue;
+        const ssize_t bytes = read(fd, buffer.data() + filled, buffer.size() - filled);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
+            break;
+        filled += bytes;
+
+        const char* begin = buffer.data();
+        const char* end = buffer.data() + filled;
+        const char* newline;
+        if (discarding)
+        {
+            newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+            if (newline == nullptr)
+            {
+                filled = 0;
+                continue;
+            }
+            begin = newline + 1;
+            discarding = false;
+        }
+        while ((newline = static_cast<const char*>(memchr(begin, '\n', end - begin))) != nullptr)
+        {
+            parse_line(begin, newline);
+            begin = newline + 1;
+        }
+        // keep the incomplete last line, a line longer than the buffer is dropped up to its end
+        filled = end - begin;
+        if (filled == buffer.size())
+        {
+            invalid_lines++;
+            filled = 0;
+            discarding = true;
+        }
+        memmove(buffer.data(), begin, filled);
+    }
+    if (filled > 0 && !stopping)
+        parse_line(buffer.data(), buffer.data() + filled);
+    finished.store(true, std::memory_order_release);
+}
+
+void RequestStream::parse_line(const char* p, const char* end)
+{
+    ///
+    /// "request [time]" or "+ x_p y_p x_d y_d load service e_p l_p e_d l_d max_ride [time]",
+    /// empty lines and comments (#) are skipped
+    ///
+    StreamRecord record;
+    const char* q = p;
+    while (q < end && (*q == ' ' || *q == '\t' || *q == '\r'))
+        ++q;
+    if (q == end || *q == '#')
+        return;
+    if (*q == '+')
+    {
+        // a new request, the drop-off unloads what the pick-up loads
+        p = q + 1;
+        record.request = 0;
+        DARPNode& pickup = record.pickup;
+        DARPNode& dropoff = record.dropoff;
+        const bool complete = parse_next(p, end, pickup.x) && parse_next(p, end, pickup.y)
+            && parse_next(p, end, dropoff.x) && parse_next(p, end, dropoff.y)
+            && parse_next(p, end, pickup.demand) && parse_next(p, end, pickup.service_time)
+            && parse_next(p, end, pickup.start_tw) && parse_next(p, end, pickup.end_tw)
+            && parse_next(p, end, dropoff.start_tw) && parse_next(p, end, dropoff.end_tw)
+            && parse_next(p, end, pickup.max_ride_time);
+        if (!complete)
+        {
+            invalid_lines++;
+            return;
+        }
+        dropoff.demand = -pickup.demand;
+        dropoff.service_time = pickup.service_time;
+        dropoff.max_ride_time = pickup.max_ride_time;
+    }
+    else if (!parse_next(p, end, record.request) || record.request == 0)
+    {
+        invalid_lines++;
+        return;
+    }
+    if (!parse_next(p, end, record.time) || record.time < 0)
+        record.time = -1;
+    // the consumer is behind, wait for a free slot
+    while (!queue.push(record) && !stopping)
+        std::this_thread::yield();
+}
+
+bool RequestStream::poll(StreamRecord& record)
+{
+    // consumer: next record that has arrived, false if there is none at the moment (does not wait)
+    return queue.pop(record);
+}
+
+bool RequestStream::at_end()
+{
+    ///
+    /// true if the stream has ended and all of its records have been polled
+    ///
+    if (!finished.load(std::memory_order_acquire) || !queue.empty())
+        return false;
+    if (invalid_lines > 0)
+        std::cerr << "Request stream: " << invalid_lines << " invalid lines skipped" << std::endl;
+    invalid_lines = 0;
+    return true;
+}
@@ -7,6 +7,9 @@ RollingHorizon<Q>::RollingHorizon(int num_requests) : DARPSolver{num_requests}
     vec_map = new std::unordered_map<NODE,int,HashFunction<Q>>[n]; 
     active_node = new std::pair<NODE,double>[2*num_requests];
     active_arc = new ARC[2*num_requests];
+    in_solution = new bool[2*num_requests]();
+    solution_node = new std::pair<NODE,double>[2*num_requests];
+    solution_arc = new ARC[2*num_requests];
     tof = new TerminalOutputFormatter<Q>();
 }
 
@@ -15,7 +18,8 @@ template<int Q>
 RollingHorizon<Q>::RollingHorizon(int num_requests, double delay, double probability) 
     : RollingHorizon<Q>{num_requests} {
     if(probability != 0 && delay != 0) {
-        this->delayIntegration = new DelayIntegration<Q>(probability, delay, tof);
+        this->delay_model = new FixedDelay(probability, delay);
+        this->delayIntegration = new DelayIntegration<Q>(delay_model, tof);
     } else {
         delayIntegration = nullptr;
     }
@@ -28,8 +32,322 @@ RollingHorizon<Q>::~RollingHorizon() {
     delete[] vec_map;
     delete[] active_node;
     delete[] active_arc;
+    delete[] in_solution;
+    delete[] solution_node;
+    delete[] solution_arc;
+    delete incumbentCallback;
+    delete budget;
+    delete batching;
+    delete delayIntegration;
+    delete delay_model;
+    delete stream;
 }
 
+template<int Q>
+void RollingHorizon<Q>::set_anytime(int policy, double target_gap, double stability_sec) {
+    delete incumbentCallback;
+    incumbentCallback = new IncumbentCallback<Q>(policy, target_gap, stability_sec);
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_budget(double min_share, double safety) {
+    delete budget;
+    budget = new SolveBudget(notify_requests_sec, min_share, safety);
+}
+
+
+template<int Q>
+void RollingHorizon<Q>::set_batching(int policy, double window, int max_size, double max_delay, double slo) {
+    delete batching;
+    batching = new BatchingPolicy(policy, window, max_size, max_delay, slo);
+}
+
+template<int Q>
+void RollingHorizon<Q>::use_delay_model(DelayModel* model) {
+    delete delay_model;
+    delay_model = model;
+    replay = nullptr;
+    if (delayIntegration)
+        delayIntegration->set_model(delay_model);
+    else
+        delayIntegration = new DelayIntegration<Q>(delay_model, tof);
+    delayIntegration->set_replay(nullptr);
+    if (simulation)
+        delayIntegration->seed(sim_seed);
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_delay_model(int type, double probability, double delay, double mu, double sigma, const std::string& file) {
+    use_delay_model(DelayModel::create(type, probability, delay, mu, sigma, file));
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_replay(const std::string& file) {
+    ReplayDelay* model = new ReplayDelay(file);
+    use_delay_model(model);
+    replay = model;
+    delayIntegration->set_replay(model);
+    std::cout << "Replay of " << file << ": " << model->get_num_reveals() << " reveals, " << model->get_num_delays() << " delays" << std::endl;
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_stream(const std::string& source, int slots) {
+    delete stream;
+    stream = new RequestStream(source);
+    stream_slots = slots;
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_record(const std::string& file) {
+    trace.open(file);
+    if (delayIntegration)
+        delayIntegration->set_trace(&trace);
+}
+
+template<int Q>
+void RollingHorizon<Q>::set_simulation(double scale, double ticks, long long nodes, int seed, const std::string& timings_file) {
+    simulation = true;
+    sim_scale = scale;
+    sim_ticks = ticks;
+    sim_nodes = nodes;
+    sim_seed = seed;
+    if (delayIntegration)
+        delayIntegration->seed(seed);
+    if (!timings_file.empty())
+    {
+        timings.open(timings_file);
+        if (!timings)
+            report_error("%s: cannot open %s\n", __FUNCTION__, timings_file.c_str());
+        timings << "milp,time_passed,new_requests,window,granted,model,solve,solved,real_time" << std::endl;
+    }
+}
+
+template<int Q>
+void RollingHorizon<Q>::schedule_reveals(DARP& D)
+{
+    // one reveal event for every request that is not known from the beginning
+    std::vector<bool> known(n+1, false);
+    for (const auto& i: D.known_requests)
+        known[i] = true;
+    if (stream)
+    {
+        // the other requests are revealed when they arrive on the stream
+        streamed = known;
+        next_slot = n - stream_slots + 1;
+        for (int i = 1; i <= n; ++i)
+        {
+            if (!known[i])
+                D.become_known_array[i-1] = DARPH_INFINITY;
+        }
+        return;
+    }
+    for (int i = 1; i <= n; ++i)
+    {
+        if (known[i])
+            continue;
+        // a replayed trace reveals the requests at the recorded times
+        double time;
+        if (replay && replay->reveal_time(i, time))
+            D.become_known_array[i-1] = time;
+        if (trace.is_open())
+            trace.record_reveal(i, D.become_known_array[i-1]);
+        events.push(D.become_known_array[i-1], EventType::reveal, i);
+    }
+}
+
+template<int Q>
+double RollingHorizon<Q>::next_batch(DARP& D, std::vector<int>& batch)
+{
+    ///
+    /// pop the requests revealed (or released from beyond the lookahead horizon) next: without batching policy
+    /// all requests revealed at the same time, otherwise the batch of the policy; returns the time at which
+    /// the batch is revealed to the solver (DARPH_INFINITY if there is no request left)
+    /// with a request stream only the records that have already arrived are read, the solver never waits for it;
+    /// while the stream is open and nothing is pending, the batch is empty and closes one answer time later
+    ///
+    std::vector<std::pair<double,int>> pending; // reveals within the longest possible batch
+    std::vector<Event> others;
+    double limit = DARPH_INFINITY;
+    bool drained = false; // no record waiting in the stream
+    while (true)
+    {
+        // the stream is in time order: pull until it is past the next event and the batch or empty
+        const double next_event = events.empty() ? DARPH_INFINITY : events.top().time;
+        if (stream && !stream_ended && !drained && stream_time <= DARPH_MIN(limit, next_event) + DARPH_EPSILON)
+        {
+            drained = !pull_stream(D);
+            continue;
+        }
+        if (events.empty() || events.top().time > limit + DARPH_EPSILON)
+            break;
+        Event e = events.pop();
+        if (e.type != EventType::reveal && e.type != EventType::release)
+        {
+            others.push_back(e);
+            continue;
+        }
+        if (pending.empty())
+            limit = e.time + (batching ? batching->get_length() : 0);
+        pending.push_back(std::make_pair(e.time, e.id));
+    }
+    for (const auto& e: others)
+        events.push(e);
+
+    batch.clear();
+    if (pending.empty() && stream && !stream_ended)
+    {
+        last_close = DARPH_MAX(time_passed, last_close) + double(notify_requests_sec) / 60;
+        return last_close;
+    }
+    if (pending.empty())
+        return DARPH_INFINITY;
+    double close = pending.front().first;
+    if (batching)
+        close = batching->close(pending, batch);
+    else
+    {
+        for (const auto& r: pending)
+            batch.push_back(r.second);
+    }
+    // requests left out of the batch are revealed later
+    for (unsigned int k = batch.size(); k < pending.size(); ++k)
+    {
+        const bool release = std::find(deferred.begin(), deferred.end(), pending[k].second) != deferred.end();
+        events.push(pending[k].first, release ? EventType::release : EventType::reveal, pending[k].second);
+    }
+    last_close = close;
+    return close;
+}
+
+template<int Q>
+bool RollingHorizon<Q>::pull_stream(DARP& D)
+{
+    ///
+    /// schedule the reveal of the next request that has arrived on the stream, on the clock of the simulation:
+    /// at the time of the record, or now (time_passed) if it has none, but not before the request before it
+    /// and not before the last batch; a new request is stored in the next reserved slot. Requests that are unknown,
+    /// already revealed or infeasible are skipped; false if no record is waiting (the stream is marked as ended
+    /// once it is closed and empty)
+    ///
+    StreamRecord record;
+    while (stream->poll(record))
+    {
+        int i = record.request;
+        if (i == 0)
+        {
+            if (next_slot > n)
+            {
+                std::cerr << "Request stream: no slot left for a new request (--stream-slots " << stream_slots << ")" << std::endl;
+                continue;
+            }
+            if (!D.fill_request(next_slot, record.pickup, record.dropoff))
+            {
+                std::cerr << "Request stream: new request with load " << record.pickup.demand << " or its time windows infeasible" << std::endl;
+                continue;
+            }
+            i = next_slot++;
+        }
+        else if (i < 1 || i > n - stream_slots || streamed[i])
+        {
+            std::cerr << "Request stream: request " << i << " unknown or already revealed" << std::endl;
+            continue;
+        }
+        streamed[i] = true;
+        const double time = (record.time < 0) ? time_passed : record.time;
+        stream_time = DARPH_MAX(DARPH_MAX(time, stream_time), DARPH_MAX(time_passed, last_close));
+        D.become_known_array[i-1] = stream_time;
+        if (trace.is_open())
+            trace.record_reveal(i, stream_time);
+        events.push(stream_time, EventType::reveal, i);
+        return true;
+    }
+    stream_ended = stream->at_end();
+    return false;
+}
+
+template<int Q>
+bool RollingHorizon<Q>::more_requests(const DARP& D) const
+{
+    // requests that never arrived on a finished stream are not waited for
+    if (stream && stream_ended && next_new_requests.empty())
+        return false;
+    return D.num_known_requests < n;
+}
+
+template<int Q>
+bool RollingHorizon<Q>::reserve_check(DARP& D, int i) const
+{
+    ///
+    /// request i is accepted without routing it if a vehicle of its own can serve it and if at no time
+    /// more requests outside the MILP are served than vehicles are held in reserve
+    ///
+    auto service = [&D, this](int j) {
+        const double pickup = DARPH_MAX(earliest_pickup(D, j), D.nodes[DARPH_DEPOT].start_tw + D.tt[DARPH_DEPOT][j]);
+        const double dropoff = DARPH_MAX(pickup + D.nodes[j].service_time + D.tt[j][n+j], D.nodes[n+j].start_tw);
+        return std::make_pair(pickup, dropoff);
+    };
+    const auto s = service(i);
+    if (s.first > D.nodes[i].end_tw + DARPH_EPSILON || s.second > D.nodes[n+i].end_tw + DARPH_EPSILON)
+        return false;
+    if (s.second - s.first - D.nodes[i].service_time > D.nodes[n+i].max_ride_time + DARPH_EPSILON)
+        return false;
+    if (s.second + D.nodes[n+i].service_time + D.tt[n+i][DARPH_DEPOT] > D.nodes[DARPH_DEPOT].end_tw + DARPH_EPSILON)
+        return false;
+
+    // all requests outside the MILP overlapping with request i could need a vehicle at the same time
+    int overlapping = 0;
+    for (const auto& j: deferred)
+    {
+        const auto t = service(j);
+        if (t.first < s.second && s.first < t.second)
+            overlapping++;
+    }
+    return overlapping < reserved_vehicles(D);
+}
+
+template<int Q>
+int RollingHorizon<Q>::reserved_vehicles(const DARP& D) const
+{
+    // ceil(reserve * K) vehicles, at least one for the requests beyond the horizon and one for the MILP
+    return DARPH_MIN(D.num_vehicles - 1, DARPH_MAX(1, int(std::ceil(lookahead_reserve * D.num_vehicles))));
+}
+
+template<int Q>
+void RollingHorizon<Q>::defer_requests(DARP& D)
+{
+    ///
+    /// new requests whose earliest pick-up lies beyond time_passed + lookahead are accepted by the reserve check
+    /// and released into the MILP lookahead minutes before their pick-up, so the size of the MILP stays
+    /// roughly constant over the day; requests failing the check are answered by the MILP as usual
+    ///
+    const auto before = clock::now();
+    std::vector<int> entering;
+    released.clear();
+    for (const auto& i: new_requests)
+    {
+        const auto it = std::find(deferred.begin(), deferred.end(), i);
+        if (it != deferred.end())
+        {
+            deferred.erase(it);
+            released.push_back(i);
+            entering.push_back(i);
+        }
+        else if (earliest_pickup(D, i) > time_passed + lookahead && reserve_check(D, i))
+        {
+            deferred.push_back(i);
+            // batches already popped from the events must not be overtaken
+            events.push(DARPH_MAX(earliest_pickup(D, i) - lookahead, last_close), EventType::release, i);
+            time_to_answer[i-1] = sec(clock::now() - before).count();
+            deferred_requests += 1;
+#if VERBOSE
+            std::cout << "request " << i << " accepted beyond the horizon, released at " << DARPH_MAX(earliest_pickup(D, i) - lookahead, last_close) << std::endl;
+#endif
+        }
+        else
+            entering.push_back(i);
+    }
+    new_requests = entering;
+}
 
 template<int Q>
 void RollingHorizon<Q>::create_maps(DARP& D, DARPGraph<Q>& G) {
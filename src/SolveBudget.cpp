@@ -0,0 +1,108 @@
+#include "DARPH.h"
+
+SolveBudget::SolveBudget(double cap, double min_share, double safety, int lookback)
+{
+    this->cap = cap;
+    this->min_share = min_share;
+    this->safety = safety;
+    this->lookback = lookback;
+    reserve = 0;
+    total_granted = 0;
+    total_used = 0;
+}
+
+double SolveBudget::predict(uint64_t model_size) const
+{
+    ///
+    /// predict the time needed to converge for a model with model_size arcs from the last iterations:
+    /// the largest observed time per arc until the last improving incumbent (or until the end of a solve
+    /// that ended before its time limit) times the safety factor, -1 if the full window should be used
+    ///
+    if (history.empty())
+        return -1;
+
+    double rate = 0;
+    int count = 0;
+    for (auto itr = history.rbegin(); itr != history.rend() && count < lookback; ++itr, ++count)
+    {
+        bool time_limit = itr->used >= itr->granted - DARPH_EPSILON;
+        double converged;
+        if (itr->last_incumbent >= 0)
+        {
+            // solution still improved at the end of the time limit: don't cut the budget
+            if (time_limit && itr->gap > DARPH_EPSILON && itr->last_incumbent > 0.9 * itr->used)
+                return -1;
+            converged = itr->last_incumbent;
+        }
+        else
+        {
+            // without incumbent statistics only a solve that ended before the time limit has converged
+            if (time_limit)
+                return -1;
+            converged = itr->used;
+        }
+        rate = DARPH_MAX(rate, converged / DARPH_MAX(1, itr->model_size));
+    }
+    return safety * rate * model_size;
+}
+
+double SolveBudget::grant(double window, uint64_t model_size)
+{
+    ///
+    /// time limit for the next solve: the predicted time to converge, at least min_share of the window;
+    /// if the window is too short the reserve is used, but the time to answer (cap) is never exceeded
+    ///
+    double need = predict(model_size);
+    if (need < 0)
+        need = window;
+
+    double granted = DARPH_MAX(need, min_share * window);
+    if (granted > window)
+    {
+        double extra = DARPH_MIN(granted - window, DARPH_MAX(0, DARPH_MIN(reserve, cap - window)));
+        reserve -= extra;
+        granted = window + extra;
+    }
+#if VERBOSE
+    std::cout << "Time budget: window " << window << "s, predicted " << need << "s, granted " << granted << "s, reserve " << reserve << "s" << std::endl;
+#endif
+    return granted;
+}
+
+void SolveBudget::record(uint64_t model_size, double window, double granted, double used, double first_incumbent, double last_incumbent, double gap)
+{
+    history.push_back({model_size, window, granted, used, first_incumbent, last_incumbent, gap});
+    total_granted += granted;
+    total_used += used;
+    // carry unused time of the window forward, bounded by the time to answer a request
+    reserve = DARPH_MIN(cap, reserve + DARPH_MAX(0, window - used));
+}
+
+double SolveBudget::draw_reserve(double min_time)
+{
+    // time for a fallback solve if no solution has been found within the granted time
+    double time = DARPH_MAX(min_time, reserve);
+    reserve = 0;
+    return time;
+}
+
+void SolveBudget::print_summary(const std::string& clock) const
+{
+    // all times are in the unit of the windows, clock says how the solve times were measured
+    double sum_window = 0;
+    double sum_first = 0;
+    int count_first = 0;
+    for (const auto& it: history)
+    {
+        sum_window += it.window;
+        if (it.first_incumbent >= 0)
+        {
+            sum_first += it.first_incumbent;
+            count_first++;
+        }
+    }
+    std::cout << MANJ_GREEN << "Solve time budget (" << clock << "): " << FORMAT_STOP << total_used << "s used of " << total_granted << "s granted (" << sum_window << "s available) in " << history.size() << " solves";
+    if (count_first > 0)
+        std::cout << ", avg time to first incumbent " << sum_first / count_first << "s";
+    std::cout << std::endl;
+}
@@ -0,0 +1,360 @@
+#include "DARPH.h"
+
+TabuSearch::TabuSearch(const DARP& D, int max_users, double now, const std::array<double,3>& w) : D{D}, n{D.num_requests}
+{
+    this->max_users = max_users;
+    this->now = now;
+    this->w = w;
+    must_serve.assign(n+1, false);
+    latest.assign(2*n+1, 0);
+    for (int k = 0; k <= 2*n; ++k)
+        latest[k] = D.nodes[k].end_tw;
+    fixed_departure.assign(2*n+1, -DARPH_INFINITY);
+    schedule.assign(2*n+1, 0);
+}
+
+void TabuSearch::add_route(const std::vector<int>& events, int open_from)
+{
+    ///
+    /// events before open_from cannot be changed anymore, the vehicle leaves the last of them not before now
+    /// the beginning of service of these events is read from D.nodes
+    ///
+    std::vector<int> driven(events.begin(), events.begin() + open_from);
+    int load = 0;
+    int users = 0;
+    for (const auto& k: driven)
+    {
+        load += D.nodes[k].demand;
+        users += (k <= n) ? 1 : -1;
+        if (k <= n)
+        {
+            // users picked up already are served anyway
+            fixed_departure[k] = D.nodes[k].beginning_service + D.nodes[k].service_time;
+            must_serve[k] = true;
+        }
+    }
+    fixed.push_back(driven);
+    open.push_back(std::vector<int>(events.begin() + open_from, events.end()));
+    anchor_load.push_back(load);
+    anchor_users.push_back(users);
+    if (driven.empty())
+    {
+        anchor_departure.push_back(DARPH_MAX(D.nodes[DARPH_DEPOT].start_tw, now));
+        departure_depot.push_back(anchor_departure.back());
+    }
+    else
+    {
+        anchor_departure.push_back(DARPH_MAX(D.nodes[driven.back()].beginning_service + D.nodes[driven.back()].service_time, now));
+        departure_depot.push_back(D.nodes[driven.front()].beginning_service - D.tt[DARPH_DEPOT][driven.front()]);
+    }
+    route.push_back(DARPRoute());
+    route_costs.push_back(0);
+}
+
+double TabuSearch::evaluate(const std::vector<int>& events, int r, DARPRoute& violations)
+{
+    ///
+    /// schedule the open part of route r as early as possible and compute the violations of
+    /// load, route duration, time windows and ride times (steps 1-5 of the 8-step scheme,
+    /// the departure at the depot is delayed as long as no time window is violated)
+    /// returns routing costs and excess ride time of the open part
+    ///
+    violations = DARPRoute();
+    if (events.empty() && fixed[r].empty())
+        return 0; // vehicle is not used
+    const int anchor = fixed[r].empty() ? DARPH_DEPOT : fixed[r].back();
+
+    auto forward = [&](double departure) {
+        double time = departure;
+        int pred = anchor;
+        for (const auto& k: events)
+        {
+            schedule[k] = DARPH_MAX(time + D.tt[pred][k], D.nodes[k].start_tw);
+            time = schedule[k] + D.nodes[k].service_time;
+            pred = k;
+        }
+        return time + D.tt[pred][DARPH_DEPOT];
+    };
+
+    double return_depot = forward(anchor_departure[r]);
+    double start = departure_depot[r];
+    if (anchor == DARPH_DEPOT && !events.empty())
+    {
+        // forward time slack at the depot
+        double waiting = 0;
+        double slack = DARPH_PLUS(D.nodes[DARPH_DEPOT].end_tw - return_depot);
+        double time = anchor_departure[r];
+        int pred = anchor;
+        for (const auto& k: events)
+        {
+            waiting += schedule[k] - (time + D.tt[pred][k]);
+            slack = DARPH_MIN(slack, waiting + DARPH_PLUS(latest[k] - schedule[k]));
+            time = schedule[k] + D.nodes[k].service_time;
+            pred = k;
+        }
+        return_depot = forward(anchor_departure[r] + DARPH_MIN(slack, waiting));
+        start = schedule[events.front()] - D.tt[DARPH_DEPOT][events.front()];
+    }
+
+    double costs = 0;
+    int load = anchor_load[r];
+    int users = anchor_users[r];
+    int pred = anchor;
+    for (const auto& k: events)
+    {
+        costs += w[0] * D.d[pred][k];
+        violations.tw_violation += DARPH_PLUS(schedule[k] - latest[k]);
+        load += D.nodes[k].demand;
+        users += (k <= n) ? 1 : -1;
+        violations.load_violation += DARPH_PLUS(load - D.veh_capacity) + DARPH_PLUS(users - max_users);
+        if (k > n)
+        {
+            double departure = (fixed_departure[k-n] > -DARPH_INFINITY) ? fixed_departure[k-n] : schedule[k-n] + D.nodes[k-n].service_time;
+            double ride_time = schedule[k] - departure;
+            violations.ride_time_violation += DARPH_PLUS(ride_time - D.nodes[k].max_ride_time);
+            costs += w[2] * DARPH_PLUS(ride_time - D.tt[k-n][k]);
+        }
+        pred = k;
+    }
+    costs += w[0] * D.d[pred][DARPH_DEPOT];
+    violations.departure_depot = start;
+    violations.return_depot = return_depot;
+    violations.tw_violation += DARPH_PLUS(return_depot - D.nodes[DARPH_DEPOT].end_tw);
+    violations.duration_violation = DARPH_PLUS(return_depot - start - D.max_route_duration);
+    violations.has_customers = !events.empty() || !fixed[r].empty();
+    return costs;
+}
+
+double TabuSearch::penalized(const DARPRoute& violations, double costs) const
+{
+    return costs + alpha * violations.load_violation + beta * violations.duration_violation + gamma * violations.tw_violation + tau * violations.ride_time_violation;
+}
+
+bool TabuSearch::feasible(const DARPRoute& violations) const
+{
+    return violations.load_violation == 0 && violations.duration_violation < DARPH_EPSILON && violations.tw_violation < DARPH_EPSILON && violations.ride_time_violation < DARPH_EPSILON;
+}
+
+double TabuSearch::best_insertion(int i, int r, std::vector<int>& events)
+{
+    // cheapest insertion of request i into the open part of route r w.r.t. the penalized costs
+    DARPRoute violations;
+    std::vector<int> trial;
+    double best = DARPH_INFINITY;
+    const double current = penalized(route[r], route_costs[r]);
+    const int m = open[r].size();
+
+    for (int pickup_gap = 0; pickup_gap <= m; ++pickup_gap)
+    {
+        for (int dropoff_gap = pickup_gap; dropoff_gap <= m; ++dropoff_gap)
+        {
+            trial = open[r];
+            trial.insert(trial.begin() + dropoff_gap, n+i);
+            trial.insert(trial.begin() + pickup_gap, i);
+            double costs = evaluate(trial, r, violations);
+            double delta = penalized(violations, costs) - current;
+            if (delta < best)
+            {
+                best = delta;
+                events = trial;
+            }
+        }
+    }
+    return best;
+}
+
+double TabuSearch::solution_costs(bool& is_feasible) const
+{
+    double costs = w[1] * unserved.size();
+    is_feasible = true;
+    for (unsigned int r = 0; r < open.size(); ++r)
+    {
+        costs += route_costs[r];
+        if (!feasible(route[r]))
+            is_feasible = false;
+    }
+    return costs;
+}
+
+void TabuSearch::run(double time_limit, unsigned int seed)
+{
+    ///
+    /// relocate one request per iteration to the route (or out of all routes if it has not been accepted yet)
+    /// with the least penalized costs; moving a request back to the route it has left is tabu for theta iterations
+    /// unless this leads to a new best solution
+    ///
+    using clock = std::chrono::system_clock;
+    using sec = std::chrono::duration<double>;
+    const auto before = clock::now();
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> noise(0, DARPH_EPSILON);
+    const int bin = open.size(); // "route" of the unserved requests
+    std::unordered_map<int,int> tabu_until; // key i * (bin+1) + r
+    bool is_feasible;
+
+    for (unsigned int r = 0; r < open.size(); ++r)
+        route_costs[r] = evaluate(open[r], r, route[r]);
+    double costs = solution_costs(is_feasible);
+    if (is_feasible && costs < best_costs)
+    {
+        found = true;
+        best_costs = costs;
+        best_open = open;
+        best_unserved = unserved;
+    }
+    // penalized costs of the current solution for the aspiration criterion
+    costs = w[1] * unserved.size();
+    for (unsigned int r = 0; r < open.size(); ++r)
+        costs += penalized(route[r], route_costs[r]);
+
+    int movable = unserved.size();
+    for (const auto& events: open)
+        movable += std::count_if(events.begin(), events.end(), [this](int k) {return k <= n;});
+    // different tenures diversify the runs of different threads
+    const int theta = DARPH_MAX(1, int(7.5 * std::log10(DARPH_MAX(movable, 2)))) + int(seed % 3);
+
+    std::vector<int> events_from, events_to, best_from, best_to;
+    DARPRoute violations;
+    while (sec(clock::now() - before).count() < time_limit && movable > 0)
+    {
+        iterations++;
+        double best_delta = DARPH_INFINITY;
+        int best_i = -1, best_r_from = -1, best_r_to = -1;
+        double best_costs_from = 0;
+        DARPRoute best_violations_from;
+
+        // candidates: requests not picked up yet and unserved requests
+        std::vector<std::pair<int,int>> candidates;
+        for (int r = 0; r < bin; ++r)
+        {
+            for (const auto& k: open[r])
+            {
+                if (k <= n)
+                    candidates.push_back(std::make_pair(k, r));
+            }
+        }
+        for (const auto& i: unserved)
+            candidates.push_back(std::make_pair(i, bin));
+
+        for (const auto& [i, r_from] : candidates)
+        {
+            double delta_from;
+            double costs_from = 0;
+            DARPRoute violations_from;
+            if (r_from < bin)
+            {
+                events_from = open[r_from];
+                events_from.erase(std::remove(events_from.begin(), events_from.end(), i), events_from.end());
+                events_from.erase(std::remove(events_from.begin(), events_from.end(), n+i), events_from.end());
+                costs_from = evaluate(events_from, r_from, violations_from);
+                delta_from = penalized(violations_from, costs_from) - penalized(route[r_from], route_costs[r_from]);
+            }
+            else
+                delta_from = -w[1];
+
+            bool tried_unused = false;
+            for (int r_to = 0; r_to <= bin; ++r_to)
+            {
+                if (r_to == r_from)
+                    continue;
+                double delta;
+                if (r_to < bin)
+                {
+                    // all unused vehicles are alike
+                    if (open[r_to].empty() && fixed[r_to].empty())
+                    {
+                        if (tried_unused)
+                            continue;
+                        tried_unused = true;
+                    }
+                    delta = delta_from + best_insertion(i, r_to, events_to);
+                }
+                else
+                {
+                    if (must_serve[i])
+                        continue;
+                    delta = delta_from + w[1];
+                }
+                delta += noise(gen); // random tie-breaking
+
+                auto itr = tabu_until.find(i * (bin+1) + r_to);
+                bool tabu = itr != tabu_until.end() && itr->second >= iterations;
+                // aspiration: penalized costs are an upper bound on the costs of a feasible solution
+                if (tabu && costs + delta >= best_costs)
+                    continue;
+                if (delta < best_delta)
+                {
+                    best_delta = delta;
+                    best_i = i;
+                    best_r_from = r_from;
+                    best_r_to = r_to;
+                    best_costs_from = costs_from;
+                    best_violations_from = violations_from;
+                    best_from = events_from;
+                    if (r_to < bin)
+                        best_to = events_to;
+                }
+            }
+        }
+        if (best_i < 0)
+            break;
+
+        // apply move
+        tabu_until[best_i * (bin+1) + best_r_from] = iterations + theta;
+        if (best_r_from < bin)
+        {
+            open[best_r_from] = best_from;
+            route[best_r_from] = best_violations_from;
+            route_costs[best_r_from] = best_costs_from;
+        }
+        else
+            unserved.erase(std::remove(unserved.begin(), unserved.end(), best_i), unserved.end());
+        if (best_r_to < bin)
+        {
+            open[best_r_to] = best_to;
+            route_costs[best_r_to] = evaluate(open[best_r_to], best_r_to, route[best_r_to]);
+        }
+        else
+            unserved.push_back(best_i);
+
+        // update penalties
+        DARPRoute total;
+        for (const auto& v: route)
+        {
+            total.load_violation += v.load_violation;
+            total.duration_violation += v.duration_violation;
+            total.tw_violation += v.tw_violation;
+            total.ride_time_violation += v.ride_time_violation;
+        }
+        alpha = (total.load_violation > 0) ? alpha * (1+delta) : alpha / (1+delta);
+        beta = (total.duration_violation > DARPH_EPSILON) ? beta * (1+delta) : beta / (1+delta);
+        gamma = (total.tw_violation > DARPH_EPSILON) ? gamma * (1+delta) : gamma / (1+delta);
+        tau = (total.ride_time_violation > DARPH_EPSILON) ? tau * (1+delta) : tau / (1+delta);
+
+        costs = solution_costs(is_feasible);
+        if (is_feasible && costs < best_costs - DARPH_EPSILON)
+        {
+            found = true;
+            best_costs = costs;
+            best_open = open;
+            best_unserved = unserved;
+        }
+        costs = w[1] * unserved.size();
+        for (unsigned int r = 0; r < open.size(); ++r)
+            costs += penalized(route[r], route_costs[r]);
+    }
+}
+
+void TabuSearch::get_best_routes(std::vector<std::vector<int>>& routes) const
+{
+    // complete routes (fixed and open part) of the best feasible solution, unused vehicles are omitted
+    routes.clear();
+    for (unsigned int r = 0; r < best_open.size(); ++r)
+    {
+        if (fixed[r].empty() && best_open[r].empty())
+            continue;
+        routes.push_back(fixed[r]);
+        routes.back().insert(routes.back().end(), best_open[r].begin(), best_open[r].end());
+    }
+}
@@ -32,7 +32,8 @@ std::string TerminalOutputFormatter<Q>::get_printable_header(int num_milps, doub
 template <int Q>
 std::string TerminalOutputFormatter<Q>::get_printable_event_block(int node_event, double time, double time_passed, int n) {
     std::stringstream output;
-    if (this->event_char_counter + 12 > get_current_terminal_width()) {
+    // uses the width cached by the last get_current_terminal_width() call
+    if (this->event_char_counter + 12 > this->terminal_width) {
         output << std::endl;
         this->event_char_counter = 0;
     }
@@ -0,0 +1,51 @@
+#include "DARPH.h"
+
+int main(int argc,char* argv[])
+{
+    ///
+    /// check that the compact distance formats return the same doubles as the matrices read as doubles,
+    /// bit for bit, for the given WSW instances (default: the shipped one), and that they are actually used where
+    /// they are exact on WSW: float32 for tt (travel times rounded in float, not the distances with two decimals),
+    /// fixed16 for d and tt; exit code 1 if not, e.g. if a matrix silently falls back to doubles
+    ///
+    std::vector<std::string> instances;
+    for (int i = 1; i < argc; ++i)
+        instances.push_back(argv[i]);
+    if (instances.empty())
+        instances.push_back("no_011_6_req");
+
+    const std::string data_directory = "data/WSW/";
+    const std::array<int,2> formats = {DARPH_COMPACT_FLOAT, DARPH_COMPACT_FIXED16};
+    const std::array<const char*,2> names = {"float32", "fixed16"};
+    const std::array<std::array<bool,2>,2> expected = {{{false, true}, {true, true}}}; // compact d, tt
+    int failed = 0;
+    for (const auto& instance: instances)
+    {
+        // the text files, not a compiled instance
+        const std::string path_to_instance = data_directory + instance + ".txt";
+        const int num_requests = DARPGetDimension(path_to_instance)/2;
+        DARP reference(num_requests);
+        reference.set_instance_mode(2);
+        reference.set_compact(DARPH_COMPACT_NONE);
+        reference.read_file(path_to_instance, data_directory, instance);
+
+        for (unsigned int k = 0; k < formats.size(); ++k)
+        {
+            DARP D(num_requests);
+            D.set_instance_mode(2);
+            D.set_compact(formats[k]);
+            D.read_file(path_to_instance, data_directory, instance);
+            const size_t differ = D.compare_distances(reference);
+            const std::array<bool,2> compact = {D.get_d().is_compact(), D.get_tt().is_compact()};
+            std::cout << instance << " " << names[k] << " (d " << (compact[0] ? names[k] : "double") << ", tt " << (compact[1] ? names[k] : "double") << "): ";
+            if (differ)
+                std::cout << "FAILED, " << differ << " entries differ" << std::endl;
+            else if ((expected[k][0] && !compact[0]) || (expected[k][1] && !compact[1]))
+                std::cout << "FAILED, format rejected where it is exact on WSW" << std::endl;
+            else
+                std::cout << "ok" << std::endl;
+            failed += (differ > 0 || (expected[k][0] && !compact[0]) || (expected[k][1] && !compact[1]));
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+#include "DARPH.h"
+
+int main(int argc,char* argv[])
+{
+    ///
+    /// compile an instance into the binary format of DARPBinary.h, which darp_cplex_3 and darp_cplex_6
+    /// load instead of the text files if it lies next to them
+    ///
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " [INSTANCE] [OUTPUT]" << std::endl;
+        return 1;
+    }
+
+    std::string instance;
+    std::string data_directory;
+
+    std::string inst(argv[1]);
+    if(inst == "no6") {
+        instance = "no_011_6_req";
+        data_directory = "data/WSW/";
+    } else {
+        instance = argv[1];
+        data_directory = "data/a_b_first_line_modified/";
+    }
+    std::string path_to_instance = data_directory + instance + ".txt";
+    std::string path_to_output = (argc > 2) ? argv[2] : data_directory + instance + ".darp";
+
+    int num_requests = DARPGetDimension(path_to_instance)/2;
+    auto D = DARP(num_requests);
+
+    // same instance modes as in darp_cplex_6
+    D.set_instance_mode(1);
+    if (data_directory == "data/WSW/")
+        D.set_instance_mode(2);
+    D.read_file(path_to_instance, data_directory, instance);
+    D.write_binary(path_to_output);
+
+    std::cout << "Compiled " << path_to_instance << " (" << num_requests << " requests) into " << path_to_output << std::endl;
+    return 0;
+}
@@ -11,7 +11,7 @@ int main(int argc,char* argv[])
     
     const std::string data_directory = "data/WSW/"; 
     
-    std::string path_to_instance = data_directory + instance + ".txt";
+    std::string path_to_instance = DARPInstancePath(data_directory, instance);
    
     
     int num_requests = DARPGetDimension(path_to_instance)/2;
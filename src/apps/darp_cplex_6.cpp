@@ -20,22 +20,232 @@ int main(int argc,char* argv[])
 
     //optional arguments
     double travel_time_delay = 0, delay = 0, probability = 0;
+    bool pipelined = false;
+    int anytime = -1;
+    double target_gap = 0.01, stability_sec = 10;
+    double budget_share = -1;
+    bool insertion = false;
+    int tabu_threads = 0;
+    double tabu_time = 1, tabu_standalone = 0;
+    int alns_workers = 0;
+    double alns_time = 600, alns_sub_time = 10, alns_share = 0.2;
+    double slice_length = 0, slice_overlap = 30, static_time = 7200;
+    int slice_threads = std::thread::hardware_concurrency();
+    int num_clusters = 0, cluster_rounds = 3;
+    int batching = -1, batch_size = 0;
+    double batch_window = 0.5, batch_max_delay = 2, batch_slo = 60;
+    bool simulation = false;
+    double sim_scale = 1, sim_ticks = 0;
+    long long sim_nodes = 0;
+    int seed = 1;
+    std::string timings_file;
+    double lookahead = 0, lookahead_reserve = 0.5;
+    int race_size = 0;
+    int delay_model = -1;
+    double delay_mu = 0, delay_sigma = 0.25;
+    std::string delay_file;
+    std::string record_file, replay_file;
+    std::string stream_source;
+    int stream_slots = 0;
+    int distance_type = DARPH_DISTANCE_AUTO;
+    int compact_format = DARPH_COMPACT_DISTANCES;
+    double robust_quantile = 0;
+    int robust_scenarios = 100;
+    int mc_scenarios = 0;
+    double mc_time = 1;
+    int mc_threads = std::thread::hardware_concurrency();
     for (int i = 2; i < argc; i++) {
         std::string arg(argv[i]);
         if ((arg == "--node-delay" || arg == "-nd") && i + 1 < argc) {
             delay = std::stod(argv[++i]);
         } else if ((arg == "--probability" || arg == "-p") && i + 1 < argc) {
             probability = std::stod(argv[++i]);
+        } else if (arg == "--pipelined" || arg == "-pl") {
+            pipelined = true;
+        } else if ((arg == "--anytime" || arg == "-at") && i + 1 < argc) {
+            std::string policy(argv[++i]);
+            if (policy == "none")
+                anytime = DARPH_STOP_NONE;
+            else if (policy == "gap")
+                anytime = DARPH_STOP_GAP;
+            else if (policy == "stability")
+                anytime = DARPH_STOP_STABILITY;
+            else if (policy == "decided")
+                anytime = DARPH_STOP_DECIDED;
+            else
+                std::cerr << "Unknown early-stop policy: " << policy << std::endl;
+        } else if (arg == "--gap" && i + 1 < argc) {
+            target_gap = std::stod(argv[++i]);
+        } else if (arg == "--stability" && i + 1 < argc) {
+            stability_sec = std::stod(argv[++i]);
+        } else if ((arg == "--budget" || arg == "-b") && i + 1 < argc) {
+            budget_share = std::stod(argv[++i]);
+        } else if (arg == "--insertion" || arg == "-ins") {
+            insertion = true;
+        } else if ((arg == "--tabu" || arg == "-ts") && i + 1 < argc) {
+            tabu_threads = std::stoi(argv[++i]);
+        } else if (arg == "--tabu-time" && i + 1 < argc) {
+            tabu_time = std::stod(argv[++i]);
+        } else if (arg == "--tabu-standalone" && i + 1 < argc) {
+            tabu_standalone = std::stod(argv[++i]);
+        } else if (arg == "--static") {
+            dynamic = false;
+        } else if (arg == "-alns" && i + 1 < argc) {
+            alns_workers = std::stoi(argv[++i]);
+        } else if (arg == "--alns-time" && i + 1 < argc) {
+            alns_time = std::stod(argv[++i]);
+        } else if (arg == "--alns-sub-time" && i + 1 < argc) {
+            alns_sub_time = std::stod(argv[++i]);
+        } else if (arg == "--alns-share" && i + 1 < argc) {
+            alns_share = std::stod(argv[++i]);
+        } else if ((arg == "--decompose" || arg == "-dc") && i + 1 < argc) {
+            slice_length = std::stod(argv[++i]);
+        } else if (arg == "--dc-overlap" && i + 1 < argc) {
+            slice_overlap = std::stod(argv[++i]);
+        } else if (arg == "--dc-threads" && i + 1 < argc) {
+            slice_threads = std::stoi(argv[++i]);
+        } else if (arg == "--static-time" && i + 1 < argc) {
+            static_time = std::stod(argv[++i]);
+        } else if ((arg == "--clusters" || arg == "-cl") && i + 1 < argc) {
+            num_clusters = std::stoi(argv[++i]);
+        } else if (arg == "--cluster-rounds" && i + 1 < argc) {
+            cluster_rounds = std::stoi(argv[++i]);
+        } else if ((arg == "--batching" || arg == "-bt") && i + 1 < argc) {
+            std::string policy(argv[++i]);
+            if (policy == "window")
+                batching = DARPH_BATCH_WINDOW;
+            else if (policy == "size")
+                batching = DARPH_BATCH_SIZE;
+            else if (policy == "slo")
+                batching = DARPH_BATCH_SLO;
+            else
+                std::cerr << "Unknown batching policy: " << policy << std::endl;
+        } else if (arg == "--batch-window" && i + 1 < argc) {
+            batch_window = std::stod(argv[++i]);
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            batch_size = std::stoi(argv[++i]);
+        } else if (arg == "--batch-max-delay" && i + 1 < argc) {
+            batch_max_delay = std::stod(argv[++i]);
+        } else if (arg == "--batch-slo" && i + 1 < argc) {
+            batch_slo = std::stod(argv[++i]);
+        } else if ((arg == "--simulate" || arg == "-sim") && i + 1 < argc) {
+            simulation = true;
+            sim_scale = std::stod(argv[++i]);
+        } else if (arg == "--sim-ticks" && i + 1 < argc) {
+            simulation = true;
+            sim_ticks = std::stod(argv[++i]);
+        } else if (arg == "--sim-nodes" && i + 1 < argc) {
+            simulation = true;
+            sim_nodes = std::stoll(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoi(argv[++i]);
+        } else if (arg == "--timings" && i + 1 < argc) {
+            timings_file = argv[++i];
+        } else if ((arg == "--lookahead" || arg == "-la") && i + 1 < argc) {
+            lookahead = std::stod(argv[++i]);
+        } else if (arg == "--lookahead-reserve" && i + 1 < argc) {
+            lookahead_reserve = std::stod(argv[++i]);
+        } else if ((arg == "--race" || arg == "-r") && i + 1 < argc) {
+            race_size = std::stoi(argv[++i]);
+        } else if ((arg == "--delay-model" || arg == "-dm") && i + 1 < argc) {
+            std::string model(argv[++i]);
+            if (model == "fixed")
+                delay_model = DARPH_DELAY_FIXED;
+            else if (model == "lognormal")
+                delay_model = DARPH_DELAY_LOGNORMAL;
+            else if (model == "tod")
+                delay_model = DARPH_DELAY_TIME_OF_DAY;
+            else if (model == "empirical")
+                delay_model = DARPH_DELAY_EMPIRICAL;
+            else
+                std::cerr << "Unknown delay model: " << model << std::endl;
+        } else if (arg == "--delay-mu" && i + 1 < argc) {
+            delay_mu = std::stod(argv[++i]);
+        } else if (arg == "--delay-sigma" && i + 1 < argc) {
+            delay_sigma = std::stod(argv[++i]);
+        } else if (arg == "--delay-file" && i + 1 < argc) {
+            delay_file = argv[++i];
+        } else if (arg == "--distances" && i + 1 < argc) {
+            std::string type = argv[++i];
+            if (type == "dense")
+                distance_type = DARPH_DISTANCE_DENSE;
+            else if (type == "computed")
+                distance_type = DARPH_DISTANCE_COMPUTED;
+            else if (type == "tiled")
+                distance_type = DARPH_DISTANCE_TILED;
+            else
+                std::cerr << "Unknown distance storage: " << type << std::endl;
+        } else if (arg == "--compact" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "none")
+                compact_format = DARPH_COMPACT_NONE;
+            else if (format == "float")
+                compact_format = DARPH_COMPACT_FLOAT;
+            else if (format == "fixed16")
+                compact_format = DARPH_COMPACT_FIXED16;
+            else
+                std::cerr << "Unknown compact format: " << format << std::endl;
+        } else if (arg == "--stream" && i + 1 < argc) {
+            stream_source = argv[++i];
+        } else if (arg == "--stream-slots" && i + 1 < argc) {
+            stream_slots = std::stoi(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_file = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (arg == "--robust" && i + 1 < argc) {
+            robust_quantile = std::stod(argv[++i]);
+        } else if (arg == "--robust-scenarios" && i + 1 < argc) {
+            robust_scenarios = std::stoi(argv[++i]);
+        } else if ((arg == "--monte-carlo" || arg == "-mc") && i + 1 < argc) {
+            mc_scenarios = std::stoi(argv[++i]);
+        } else if (arg == "--mc-time" && i + 1 < argc) {
+            mc_time = std::stod(argv[++i]);
+        } else if (arg == "--mc-threads" && i + 1 < argc) {
+            mc_threads = std::stoi(argv[++i]);
         } else {
             std::cerr << "Unknown argument: " << arg << std::endl;
         }
     }
         
-    std::string path_to_instance = data_directory + instance + ".txt";
+    std::string path_to_instance = DARPInstancePath(data_directory, instance);
     int num_requests = DARPGetDimension(path_to_instance)/2;
+    // new requests of the stream are stored in slots after the requests of the instance
+    if (stream_source.empty())
+        stream_slots = 0;
     
     auto D = DARP(num_requests);
-    auto RH = RollingHorizon<6>(num_requests, delay, probability);  
+    auto RH = RollingHorizon<6>(num_requests + stream_slots, delay, probability);  
+    RH.set_pipelined(pipelined);
+    if (anytime >= 0)
+        RH.set_anytime(anytime, target_gap, stability_sec);
+    if (budget_share >= 0)
+        RH.set_budget(budget_share, 3);
+    if (batching >= 0)
+        RH.set_batching(batching, batch_window, batch_size, batch_max_delay, batch_slo);
+    RH.set_seed(seed);
+    if (simulation || !timings_file.empty())
+        RH.set_simulation(sim_scale, sim_ticks, sim_nodes, seed, timings_file);
+    if (delay_model >= 0)
+        RH.set_delay_model(delay_model, probability, delay, delay_mu, delay_sigma, delay_file);
+    if (!replay_file.empty())
+        RH.set_replay(replay_file);
+    if (!stream_source.empty())
+        RH.set_stream(stream_source, stream_slots);
+    if (!record_file.empty())
+        RH.set_record(record_file);
+    RH.set_lookahead(lookahead, lookahead_reserve);
+    RH.set_insertion(insertion);
+    if (race_size > 1)
+        RH.set_race(race_size);
+    if (robust_quantile > 0)
+        RH.set_robust_planning(robust_quantile, robust_scenarios);
+    if (mc_scenarios > 0)
+        RH.set_robustness(mc_scenarios, mc_time, mc_threads);
+    RH.set_tabu(tabu_threads, tabu_time, tabu_standalone);
+    RH.set_alns(alns_workers, alns_time, alns_sub_time, alns_share);
+    RH.set_decomposition(slice_length, slice_overlap, slice_threads, static_time);
+    RH.set_clustering(num_clusters, cluster_rounds);
     
     // switch between different types of instances
     // 1: instances Berbeglia et al. (2012)
@@ -43,6 +253,8 @@ int main(int argc,char* argv[])
     D.set_instance_mode(1);
     if (data_directory == "data/WSW/")
         D.set_instance_mode(2);
+    D.set_distance_type(distance_type);
+    D.set_compact(compact_format);
 
     // read instance from file
     D.read_file(path_to_instance, data_directory, instance);
@@ -52,9 +264,14 @@ int main(int argc,char* argv[])
 
     // instance mode 1: transform instance into dynamic instance, see Berbeglia et al. (2012)
     // instance mode 2: save times of show-up to become_known_array
-    D.transform_dynamic();
+    // static: all requests are known from the beginning
+    if (dynamic)
+        D.transform_dynamic();
+    else
+        D.make_static();
+    D.reserve_requests(stream_slots);
 
-    auto G = DARPGraph<6>(num_requests);
+    auto G = DARPGraph<6>(num_requests + stream_slots);
     
     // consider excess ride time or not 
     if (D.get_instance_mode() == 2)